@@ -20,10 +20,16 @@
 
     2020 Aug. 11 the first version
     2023 Mar.  6 added License description
+    2026 Oct. 17 rankmap_order for the binary neighbor table
+    2026 Oct. 17 select_rankmap_order() for --order=
+    2026 Oct. 17 check_rankmap_order() in calc_rankid_default.c
 
  */
+#include <string.h>
 
 // change this function for different rankmap
+//   rankmap_order and select_rankmap_order() below describe the lexical order:
+//   remove them for a different rankmap (see calc_rankid_default.c)
 int calc_rankid(const int *coords, const int *psize){
   return coords[0] + psize[0]*(coords[1] + psize[1]*(coords[2] + psize[2]*coords[3]));
 }
@@ -39,3 +45,11 @@ void get_rank_coord(int *coords, int rank, const int *psize){
 
 // for output log
 const char* rankmap_name="lexical rankmap";
+
+// for the binary neighbor table (RANKMAP4D_TABLE_ORDER_LEX in rankmap4d_table.h)
+int rankmap_order=0;
+
+// --order=NAME: only this order is in the binary (see calc_rankid_order.c)
+int select_rankmap_order(const char *name){
+  return strcmp(name, "lex") != 0;
+}
@@ -0,0 +1,46 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+ */
+#include "rankmap4d_table.h"
+
+/**************************************************
+
+  default of the rankid order information, for a calc_rankid.c
+  which defines only calc_rankid(), get_rank_coord() and rankmap_name
+  (weak symbols: calc_rankid.c, calc_rankid_reversed.c and
+  calc_rankid_order.c override them)
+
+**************************************************/
+
+// for the binary neighbor table: not one of the orders of calc_rankid_order.c
+__attribute__((weak)) int rankmap_order=RANKMAP4D_TABLE_ORDER_CUSTOM;
+
+// --order=NAME: only the order of calc_rankid.c is in the binary
+__attribute__((weak)) int select_rankmap_order(const char *name){
+  (void)name;
+  return 1;
+}
+
+// the order fits any process lattice
+__attribute__((weak)) int check_rankmap_order(const int *psize){
+  (void)psize;
+  return 0;
+}
@@ -0,0 +1,343 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+                 the rankid order is selected at run time (--order=)
+    2026 Oct. 17 check_rankmap_order(): the block size must divide the process lattice
+ */
+#include <stdio.h>
+#include <string.h>
+
+/**************************************************
+
+  rankid orders: replaces calc_rankid.c
+
+    lex:      rankid = p1 + p2 P1 + p3 P1 P2 + p4 P1 P2 P3
+    reversed: rankid = p4 + p3 P4 + p2 P4 P3 + p1 P4 P3 P2
+    blocked:B1xB2xB3xB4
+              lex in a block of B1xB2xB3xB4 processes,
+              then lex over the blocks (block-major)
+    morton:   Z-order curve
+    hilbert:  Hilbert curve
+    the curves are on the smallest 2^m cube containing the process
+    lattice; the processes outside the lattice are skipped, so that
+    the rankid is contiguous for any process lattice
+
+**************************************************/
+typedef struct {
+  const char *name;    // for --order=
+  const char *log;     // for output log
+  int order;           // RANKMAP4D_TABLE_ORDER_* in rankmap4d_table.h
+  int  (*calc_rankid)(const int *coords, const int *psize);
+  void (*get_rank_coord)(int *coords, int rank, const int *psize);
+} rankid_order;
+
+
+static int calc_rankid_lex(const int *coords, const int *psize){
+  return coords[0] + psize[0]*(coords[1] + psize[1]*(coords[2] + psize[2]*coords[3]));
+}
+
+static void get_rank_coord_lex(int *coords, int rank, const int *psize){
+  int tmp=rank;
+  for(int i=0; i<3; i++){
+    coords[i]=tmp % psize[i];
+    tmp /= psize[i];
+  }
+  coords[3]=tmp;
+}
+
+
+static int calc_rankid_reversed(const int *coords, const int *psize){
+  return coords[3] + psize[3]*(coords[2] + psize[2]*(coords[1] + psize[1]*coords[0]));
+}
+
+static void get_rank_coord_reversed(int *coords, int rank, const int *psize){
+  int tmp=rank;
+  for(int i=3; i>0; i--){
+    coords[i]=tmp % psize[i];
+    tmp /= psize[i];
+  }
+  coords[0]=tmp;
+}
+
+
+/********************************************************
+ * block-major lex
+ *   the block size must divide the process lattice
+ ********************************************************/
+static int order_block[4]={1,1,1,1};
+
+static int calc_rankid_blocked(const int *coords, const int *psize){
+  const int *b=order_block;
+  int inner[4], outer[4], nblock[4];
+  for(int i=0; i<4; i++){
+    inner[i]=coords[i] % b[i];
+    outer[i]=coords[i] / b[i];
+    nblock[i]=psize[i] / b[i];
+  }
+  return calc_rankid_lex(inner, b)
+    + b[0]*b[1]*b[2]*b[3]*calc_rankid_lex(outer, nblock);
+}
+
+static void get_rank_coord_blocked(int *coords, int rank, const int *psize){
+  const int *b=order_block;
+  int block_size=b[0]*b[1]*b[2]*b[3];
+  int inner[4], outer[4], nblock[4];
+  for(int i=0; i<4; i++){
+    nblock[i]=psize[i] / b[i];
+  }
+  get_rank_coord_lex(inner, rank % block_size, b);
+  get_rank_coord_lex(outer, rank / block_size, nblock);
+  for(int i=0; i<4; i++){
+    coords[i]=inner[i] + b[i]*outer[i];
+  }
+}
+
+
+/********************************************************
+ * space filling curves
+ *   the cube of 2^level is divided into 16 children,
+ *   which are visited in the order of the curve.
+ *   child label: bit i is the upper half in the i-th direction
+ *   rankid = number of the processes in the preceding children
+ ********************************************************/
+typedef struct {
+  int entry;   // entry corner (label) of the current cube
+  int dir;     // intra direction
+} curve_state;
+
+typedef void (*curve_child)(int *label, curve_state *next, const curve_state *s, const int w);
+
+// Z-order: the children are in the order of the label
+static void morton_child(int *label, curve_state *next, const curve_state *s, const int w){
+  *label=w;
+  *next=*s;
+}
+
+// Hilbert curve in 4-dim
+//   C. H. Hamilton, "Compact Hilbert Indices", Tech. Rep. CS-2006-07,
+//   Dalhousie University (2006)
+static int gray_code(const int i){
+  return i ^ (i>>1);
+}
+
+static int rotl4(const int x, const int k){
+  int s=k%4;
+  return ((x<<s) | (x>>(4-s))) & 15;
+}
+
+static int trailing_ones(int i){
+  int n=0;
+  while(i&1){
+    i>>=1;
+    n++;
+  }
+  return n;
+}
+
+static void hilbert_child(int *label, curve_state *next, const curve_state *s, const int w){
+  *label = rotl4(gray_code(w), s->dir+1) ^ s->entry;
+
+  int entry = (w==0) ? 0 : gray_code(2*((w-1)/2));
+  int dir = (w==0) ? 0 : ((w%2==0) ? trailing_ones(w-1) : trailing_ones(w)) % 4;
+  next->entry = s->entry ^ rotl4(entry, s->dir+1);
+  next->dir = (s->dir + dir + 1) % 4;
+}
+
+// smallest m with 2^m >= psize[i]
+static int curve_levels(const int *psize){
+  int m=0;
+  for(int i=0; i<4; i++){
+    while((1<<m) < psize[i]){
+      m++;
+    }
+  }
+  return m;
+}
+
+// number of the processes in the child (of size half) of the cube at lo
+static int child_count(const int *lo, const int label, const int half, const int *psize){
+  int n=1;
+  for(int i=0; i<4; i++){
+    int c = psize[i] - (lo[i] + ((label>>i)&1)*half);
+    if(c<=0){ return 0; }
+    n *= (c<half) ? c : half;
+  }
+  return n;
+}
+
+static int curve_calc_rankid(const int *coords, const int *psize, curve_child child){
+  int lo[4]={0,0,0,0};
+  curve_state s={0,0};
+  int rank=0;
+  for(int level=curve_levels(psize)-1; level>=0; level--){
+    int half=1<<level;
+    int target=0;
+    for(int i=0; i<4; i++){
+      target |= ((coords[i]>>level)&1) << i;
+    }
+    for(int w=0; w<16; w++){
+      int label;
+      curve_state next;
+      child(&label, &next, &s, w);
+      if(label==target){
+        s=next;
+        break;
+      }
+      rank+=child_count(lo, label, half, psize);
+    }
+    for(int i=0; i<4; i++){
+      lo[i] += ((target>>i)&1)*half;
+    }
+  }
+  return rank;
+}
+
+static void curve_get_rank_coord(int *coords, int rank, const int *psize, curve_child child){
+  int lo[4]={0,0,0,0};
+  curve_state s={0,0};
+  for(int level=curve_levels(psize)-1; level>=0; level--){
+    int half=1<<level;
+    for(int w=0; w<16; w++){
+      int label;
+      curve_state next;
+      child(&label, &next, &s, w);
+      int n=child_count(lo, label, half, psize);
+      if(rank<n){
+        s=next;
+        for(int i=0; i<4; i++){
+          lo[i] += ((label>>i)&1)*half;
+        }
+        break;
+      }
+      rank-=n;
+    }
+  }
+  for(int i=0; i<4; i++){
+    coords[i]=lo[i];
+  }
+}
+
+static int calc_rankid_morton(const int *coords, const int *psize){
+  return curve_calc_rankid(coords, psize, morton_child);
+}
+
+static void get_rank_coord_morton(int *coords, int rank, const int *psize){
+  curve_get_rank_coord(coords, rank, psize, morton_child);
+}
+
+static int calc_rankid_hilbert(const int *coords, const int *psize){
+  return curve_calc_rankid(coords, psize, hilbert_child);
+}
+
+static void get_rank_coord_hilbert(int *coords, int rank, const int *psize){
+  curve_get_rank_coord(coords, rank, psize, hilbert_child);
+}
+
+
+/********************************************************
+ * registry
+ ********************************************************/
+static const rankid_order order_list[]={
+  {"lex",      "lexical rankmap",          0, calc_rankid_lex,      get_rank_coord_lex},
+  {"reversed", "reversed lexical rankmap", 1, calc_rankid_reversed, get_rank_coord_reversed},
+  {"blocked",  "blocked lexical rankmap",  2, calc_rankid_blocked,  get_rank_coord_blocked},
+  {"morton",   "Morton (Z-order) rankmap", 3, calc_rankid_morton,   get_rank_coord_morton},
+  {"hilbert",  "Hilbert rankmap",          4, calc_rankid_hilbert,  get_rank_coord_hilbert},
+};
+static const rankid_order *current_order=order_list;
+
+int calc_rankid(const int *coords, const int *psize){
+  return current_order->calc_rankid(coords, psize);
+}
+
+void get_rank_coord(int *coords, int rank, const int *psize){
+  current_order->get_rank_coord(coords, rank, psize);
+}
+
+// name of the k-th order, or NULL (for rankmap_4d_test_order)
+const char *rankmap_order_name(const int k){
+  if(k<0 || k>=(int)(sizeof(order_list)/sizeof(order_list[0]))){
+    return NULL;
+  }
+  return order_list[k].name;
+}
+
+// for output log
+const char* rankmap_name="lexical rankmap";
+
+// for the binary neighbor table
+int rankmap_order=0;
+
+/********************************************************
+ * --order=NAME
+ *   returns 0 if the order is known
+ *   blocked needs the block size: blocked:B1xB2xB3xB4
+ ********************************************************/
+int select_rankmap_order(const char *name){
+  const char *arg=strchr(name, ':');
+  size_t len = arg ? (size_t)(arg-name) : strlen(name);
+  for(size_t k=0; k<sizeof(order_list)/sizeof(order_list[0]); k++){
+    const rankid_order *o=order_list+k;
+    if(strlen(o->name) != len || strncmp(o->name, name, len) != 0){
+      continue;
+    }
+    if(o->calc_rankid == calc_rankid_blocked){
+      int *b=order_block;
+      if(!arg || sscanf(arg+1, "%dx%dx%dx%d", b, b+1, b+2, b+3) != 4
+         || b[0]<1 || b[1]<1 || b[2]<1 || b[3]<1){
+        return 1;
+      }
+    } else if(arg){
+      return 1;
+    }
+    current_order=o;
+    rankmap_name=o->log;
+    if(o->calc_rankid == calc_rankid_blocked){
+      static char blocked_name[64];
+      snprintf(blocked_name, sizeof(blocked_name), "%s (%dx%dx%dx%d blocks)", o->log,
+               order_block[0], order_block[1], order_block[2], order_block[3]);
+      rankmap_name=blocked_name;
+    }
+    rankmap_order=o->order;
+    return 0;
+  }
+  return 1;
+}
+
+
+/********************************************************
+ * the selected order on the process lattice
+ *   blocked: each block size Bi must divide Pi
+ *   returns 0, or 1 with the reason to stdout
+ ********************************************************/
+int check_rankmap_order(const int *psize){
+  if(current_order->calc_rankid != calc_rankid_blocked){
+    return 0;
+  }
+  for(int i=0; i<4; i++){
+    if(psize[i] % order_block[i] != 0){
+      printf("%s does not fit the process lattice %dx%dx%dx%d: B%d=%d does not divide P%d=%d\n",
+             rankmap_name, psize[0], psize[1], psize[2], psize[3],
+             i+1, order_block[i], i+1, psize[i]);
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -20,8 +20,12 @@
 
     2020 Aug. 11 the first version
     2023 Mar.  6 added License description
+    2026 Oct. 17 rankmap_order for the binary neighbor table
+    2026 Oct. 17 select_rankmap_order() for --order=
+    2026 Oct. 17 check_rankmap_order() in calc_rankid_default.c
 
  */
+#include <string.h>
 
 // reversed lexical rankmap: used in Grid
 int calc_rankid(const int *coords, const int *psize){
@@ -40,3 +44,11 @@ void get_rank_coord(int *coords, int rank, const int *psize){
 
 // for output log
 const char* rankmap_name="reversed lexical rankmap";
+
+// for the binary neighbor table (RANKMAP4D_TABLE_ORDER_REVERSED in rankmap4d_table.h)
+int rankmap_order=1;
+
+// --order=NAME: only this order is in the binary (see calc_rankid_order.c)
+int select_rankmap_order(const char *name){
+  return strcmp(name, "reversed") != 0;
+}
@@ -19,6 +19,9 @@
 
     2020 Aug. 11 the first version
     2023 Mar.  6 added License description
+    2026 Oct. 17 CMGs of a node for the binding (--bind)
+    2026 Oct. 17 member table of an ensemble
+    2026 Oct. 17 host-based rankmap files (--format=)
 
  */
 #ifndef rankmap_4d_config_h
@@ -27,4 +30,39 @@
 // output filename
 #define RANK_MAP_FILE "rankmap_4d_list.txt"
 
+// binary neighbor table (--table), see rankmap4d_table.h
+#define RANK_MAP_TABLE_FILE "rankmap_4d_table.bin"
+
+// ranked summary of the automatic search (--auto)
+#define RANK_MAP_AUTO_FILE "rankmap_4d_auto.txt"
+
+// time and memory of each phase (--profile), in JSON
+#define RANK_MAP_PROFILE_FILE "rankmap_4d_profile.json"
+
+// members of an ensemble (rankmap_4d_ensemble)
+#define RANK_MAP_ENSEMBLE_FILE "rankmap_4d_ensemble.txt"
+
+// CPU and memory binding of each rankid (--bind)
+#define RANK_MAP_BIND_FILE "rankmap_4d_bind.txt"
+
+// host-based rankmap files for other launchers (--format=NAME)
+#define RANK_MAP_RANKFILE    "rankmap_4d_rankfile.txt"
+#define RANK_MAP_SLURM_FILE  "rankmap_4d_slurm_hosts.txt"
+#define RANK_MAP_MACHINEFILE "rankmap_4d_machinefile.txt"
+
+// CMGs (core memory groups) of a node: A64FX has 4 CMGs of 12 compute cores,
+// the compute cores are 12-59 and the memory of CMG i is on the NUMA node 4+i
+#ifndef CMG_NUM
+#define CMG_NUM 4
+#endif
+#ifndef CMG_CORES
+#define CMG_CORES 12
+#endif
+#ifndef CMG_FIRST_CORE
+#define CMG_FIRST_CORE 12
+#endif
+#ifndef CMG_FIRST_MEM
+#define CMG_FIRST_MEM 4
+#endif
+
 #endif
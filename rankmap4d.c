@@ -0,0 +1,235 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+    2026 Oct. 17 fields of the fallback mapper in proc_dim
+    2026 Oct. 17 RANKMAP4D_ERROR instead of the abort, if the process lattice does not fit
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <mpi.h>
+#include "rankmap4d.h"
+#include "rankmap_4d_core.h"
+#include "topology.h"
+
+// global (prefixed, see rankmap4d_prefix.h)
+int np;
+int myrank;
+const char* rankmap_name="lexical rankmap";
+
+static MPI_Comm lib_comm=MPI_COMM_NULL;
+static int lib_order=RANKMAP4D_LEX;
+
+
+/**************************************************
+
+  provided for the shared code
+
+**************************************************/
+void safe_abort_(int status, const char* file, int line){
+  printf("safe_abort is called in %s, at line %d:  status=%d\n", file, line, status);
+  fflush(stdout);
+  MPI_Abort(lib_comm, status);
+}
+
+void check_error(const int rc, const int success, const char* msg){
+  int err = (rc != success);
+  int err_all;
+  MPI_Allreduce(&err, &err_all, 1, MPI_INT, MPI_MAX, lib_comm);
+  if(err_all){
+    if(myrank==0){
+      fprintf(stderr, "error at %s\n", msg);
+    }
+    safe_abort(EXIT_FAILURE);
+  }
+}
+
+// both of calc_rankid.c and calc_rankid_reversed.c
+int calc_rankid(const int *coords, const int *psize){
+  if(lib_order == RANKMAP4D_REVERSED){
+    return coords[3] + psize[3]*(coords[2] + psize[2]*(coords[1] + psize[1]*coords[0]));
+  }
+  return coords[0] + psize[0]*(coords[1] + psize[1]*(coords[2] + psize[2]*coords[3]));
+}
+
+void get_rank_coord(int *coords, int rank, const int *psize){
+  int tmp=rank;
+  if(lib_order == RANKMAP4D_REVERSED){
+    for(int i=3; i>0; i--){
+      coords[i]=tmp % psize[i];
+      tmp /= psize[i];
+    }
+    coords[0]=tmp;
+    return;
+  }
+  for(int i=0; i<3; i++){
+    coords[i]=tmp % psize[i];
+    tmp /= psize[i];
+  }
+  coords[3]=tmp;
+}
+
+
+/********************************************************
+ * process lattice from the given sizes
+ *   returns RANKMAP4D_ERROR for a bad process size,
+ *   on all the ranks
+ ********************************************************/
+static int set_proc_dim(proc_dim *dim, const int *psize, const int *intra_psize, const int ppn){
+  int total=1;
+  int intra_total=1;
+  dim->ppn=ppn;
+  dim->notofu_dir=-1;
+  dim->fold.type=FOLD_NONE;
+  dim->physical=0;
+  dim->fallback_time=0.0;
+  dim->fallback=0;
+  for(int i=0; i<4; i++){
+    dim->psize[i]=psize[i];
+    if(intra_psize){
+      dim->intra_psize[i]=intra_psize[i];
+    } else {
+      // the first direction of size ppn
+      dim->intra_psize[i] = (psize[i]==ppn && intra_total==1) ? ppn : 1;
+    }
+    dim->lattice[i]=0;
+    if(dim->psize[i]<1 || dim->intra_psize[i]<1 || dim->psize[i] % dim->intra_psize[i] != 0){
+      return RANKMAP4D_ERROR;
+    }
+    total*=dim->psize[i];
+    intra_total*=dim->intra_psize[i];
+    if(dim->psize[i] == dim->intra_psize[i]){
+      dim->notofu_dir=i;
+    }
+  }
+  dim->site_bytes=0;
+  if(total != np || intra_total != ppn){
+    return RANKMAP4D_ERROR;
+  }
+  return RANKMAP4D_SUCCESS;
+}
+
+
+/********************************************************
+ * the reordered 4-dim Cartesian communicator
+ *   the same map as rankmap_4d_general, without the rank list:
+ *   each rank computes its own rankid, and MPI_Comm_split
+ *   reorders the ranks
+ ********************************************************/
+int rankmap4d_create_comm(MPI_Comm comm, const int *psize, const int *intra_psize,
+                          const int order, MPI_Comm *cart_comm){
+  *cart_comm=MPI_COMM_NULL;
+  if(order != RANKMAP4D_LEX && order != RANKMAP4D_REVERSED){
+    return RANKMAP4D_ERROR;
+  }
+  lib_comm=comm;
+  lib_order=order;
+  rankmap_name = (order == RANKMAP4D_LEX) ? "lexical rankmap" : "reversed lexical rankmap";
+  MPI_Comm_rank(comm, &myrank);
+  MPI_Comm_size(comm, &np);
+
+  // node coordinate: the topology is given for the rank in MPI_COMM_WORLD
+  int world_rank;
+  MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+  int dim_fjmpi=0;
+  int coords_fjmpi[4]={0,0,0,0};
+  int shape_fjmpi[3]={1,1,1};
+  int periodic[3]={1,1,1};
+  int err=0;
+  err |= topology_get_dimension(&dim_fjmpi);
+  err |= (dim_fjmpi != 3);
+  if(!err){
+    err |= topology_get_coords(world_rank, 3, coords_fjmpi);
+    err |= topology_get_shape(shape_fjmpi);
+    err |= topology_get_periodic(periodic);
+  }
+  int node=node_index(coords_fjmpi, shape_fjmpi);
+  err |= (node<0);
+
+  // intra-node rank, and the same number of the processes on all the nodes
+  MPI_Comm node_comm;
+  int intra_rank;
+  int node_np;
+  MPI_Comm_split(comm, node<0 ? 0 : node, myrank, &node_comm);
+  MPI_Comm_rank(node_comm, &intra_rank);
+  MPI_Comm_size(node_comm, &node_np);
+  MPI_Comm_free(&node_comm);
+  int np_minmax[2]={-node_np, node_np};
+  MPI_Allreduce(MPI_IN_PLACE, np_minmax, 2, MPI_INT, MPI_MAX, comm);
+
+  proc_dim dim;
+  if(!err){
+    err |= (-np_minmax[0] != np_minmax[1]);
+    err |= set_proc_dim(&dim, psize, intra_psize, node_np);
+  }
+  MPI_Allreduce(MPI_IN_PLACE, &err, 1, MPI_INT, MPI_MAX, comm);
+  if(err){
+    return RANKMAP4D_ERROR;
+  }
+  for(int i=0; i<3; i++){
+    dim.periodic[i]=periodic[i];
+  }
+
+  // the map: RANKMAP4D_ERROR if the process lattice does not fit to the nodes
+  int dirmap[4];
+  int found=find_direction_map(dirmap, &dim, shape_fjmpi);
+  MPI_Allreduce(MPI_IN_PLACE, &found, 1, MPI_INT, MPI_MIN, comm);
+  if(!found){
+    return RANKMAP4D_ERROR;
+  }
+  int coords[4];
+  calc_proc_coords(coords, coords_fjmpi, intra_rank, dirmap, &dim);
+  int rankid=calc_rankid(coords, dim.psize);
+
+  // reorder
+  MPI_Comm ordered;
+  MPI_Comm_split(comm, 0, rankid, &ordered);
+  int dims[4];
+  int periods[4]={1,1,1,1};
+  for(int i=0; i<4; i++){
+    dims[i] = (order == RANKMAP4D_LEX) ? psize[3-i] : psize[i];
+  }
+  MPI_Cart_create(ordered, 4, dims, periods, 0, cart_comm);
+  MPI_Comm_free(&ordered);
+
+  // sanity check: the rank is the rankid
+  int new_rank;
+  MPI_Comm_rank(*cart_comm, &new_rank);
+  err = (new_rank != rankid);
+  MPI_Allreduce(MPI_IN_PLACE, &err, 1, MPI_INT, MPI_MAX, comm);
+  if(err){
+    MPI_Comm_free(cart_comm);
+    return RANKMAP4D_ERROR;
+  }
+  return RANKMAP4D_SUCCESS;
+}
+
+
+// the process coordinate (p1,p2,p3,p4) of the rank in the Cartesian communicator
+int rankmap4d_get_coords(MPI_Comm cart_comm, const int rank, const int order, int *coords){
+  int cart_coords[4];
+  int rc=MPI_Cart_coords(cart_comm, rank, 4, cart_coords);
+  if(rc != MPI_SUCCESS){
+    return RANKMAP4D_ERROR;
+  }
+  for(int i=0; i<4; i++){
+    coords[i] = (order == RANKMAP4D_LEX) ? cart_coords[3-i] : cart_coords[i];
+  }
+  return RANKMAP4D_SUCCESS;
+}
@@ -0,0 +1,62 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+ */
+#ifndef rankmap4d_h
+#define rankmap4d_h
+
+#include <mpi.h>
+
+/**************************************************
+
+  librankmap4d: the rankmap inside a running job
+
+    returns a 4-dim Cartesian communicator of which rank order
+    is calc_rankid() over the topology-optimal process coordinates,
+    instead of "mpirun --vcoordfile rankmap_4d_list.txt"
+
+    psize[4]:       process lattice (P1,P2,P3,P4)
+    intra_psize[4]: intra-node process lattice, or NULL to take the
+                    first direction of which size is the processes
+                    per node (as rankmap_4d)
+    order:          RANKMAP4D_LEX or RANKMAP4D_REVERSED
+
+    the dims of the Cartesian communicator are
+      (P4,P3,P2,P1) for RANKMAP4D_LEX, as MPI runs the last one fastest
+      (P1,P2,P3,P4) for RANKMAP4D_REVERSED
+    rankmap4d_get_coords() returns (p1,p2,p3,p4) in both cases
+
+    collective over comm; O(1) memory per rank
+    returns RANKMAP4D_ERROR on all the ranks for a bad process size
+    or a process lattice which does not fit to the nodes;
+    nothing is printed to stdout
+
+**************************************************/
+#define RANKMAP4D_LEX       0   // rankid = p1 + p2 P1 + p3 P1 P2 + p4 P1 P2 P3
+#define RANKMAP4D_REVERSED  1   // rankid = p4 + p3 P4 + p2 P4 P3 + p1 P4 P3 P2
+
+#define RANKMAP4D_SUCCESS   0
+#define RANKMAP4D_ERROR     1
+
+int rankmap4d_create_comm(MPI_Comm comm, const int *psize, const int *intra_psize,
+                          const int order, MPI_Comm *cart_comm);
+int rankmap4d_get_coords(MPI_Comm cart_comm, const int rank, const int order, int *coords);
+
+#endif
@@ -0,0 +1,81 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+    2026 Oct. 17 topology_get_tofu_coords
+    2026 Oct. 17 find_direction_map
+    2026 Oct. 17 topology description file
+ */
+#ifndef rankmap4d_prefix_h
+#define rankmap4d_prefix_h
+
+/**************************************************
+
+  names of the shared code in librankmap4d
+    rankmap_4d_core.c, rankmap_write.c and topology_*.c (with rankmap_topofile.c
+    for topology_file.c) are compiled with
+    -DRANKMAP4D_LIBRARY, so that they do not conflict with
+    the names in the application
+
+**************************************************/
+#ifdef RANKMAP4D_LIBRARY
+
+#define np                    rankmap4d_np
+#define myrank                rankmap4d_myrank
+#define safe_abort_           rankmap4d_safe_abort_
+#define check_error           rankmap4d_check_error
+#define calc_rankid           rankmap4d_calc_rankid
+#define get_rank_coord        rankmap4d_get_rank_coord
+#define rankmap_name          rankmap4d_rankmap_name
+
+#define get_param             rankmap4d_get_param
+#define set_direction_map     rankmap4d_set_direction_map
+#define find_direction_map    rankmap4d_find_direction_map
+#define print_fold            rankmap4d_print_fold
+#define calc_proc_coords      rankmap4d_calc_proc_coords
+#define ring_coord            rankmap4d_ring_coord
+#define set_periodic          rankmap4d_set_periodic
+#define set_lattice           rankmap4d_set_lattice
+#define print_placement       rankmap4d_print_placement
+#define node_index            rankmap4d_node_index
+#define build_rank_list       rankmap4d_build_rank_list
+#define check_rank_list       rankmap4d_check_rank_list
+#define output_rankmap        rankmap4d_output_rankmap
+#define format_rankmap        rankmap4d_format_rankmap
+#define write_rankmap_file    rankmap4d_write_rankmap_file
+
+#define topology_get_dimension rankmap4d_topology_get_dimension
+#define topology_get_coords    rankmap4d_topology_get_coords
+#define topology_get_shape     rankmap4d_topology_get_shape
+#define topology_get_periodic  rankmap4d_topology_get_periodic
+#define topology_get_tofu_coords rankmap4d_topology_get_tofu_coords
+#define topology_sim_config    rankmap4d_topology_sim_config
+#define topology_sim_nodes     rankmap4d_topology_sim_nodes
+#define read_topofile          rankmap4d_read_topofile
+#define topofile_host          rankmap4d_topofile_host
+#define free_topofile          rankmap4d_free_topofile
+#define hostmap_format         rankmap4d_hostmap_format
+#define hostmap_filename       rankmap4d_hostmap_filename
+#define write_hostmap          rankmap4d_write_hostmap
+#define output_hostmap         rankmap4d_output_hostmap
+#define topology_name          rankmap4d_topology_name
+
+#endif
+
+#endif
@@ -0,0 +1,143 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+ */
+#ifndef rankmap4d_table_h
+#define rankmap4d_table_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**************************************************
+
+  binary neighbor table (written with --table)
+    for the application: mmap it read-only and index it directly
+
+    header (RANKMAP4D_TABLE_HEADER_SIZE bytes), then np entries
+    in the rankid order; native byte order (see endian)
+
+    direction index: 2*mu + (0: forward, 1: backward), mu=0..3
+
+**************************************************/
+#define RANKMAP4D_TABLE_MAGIC        "RMAP4DTB"
+#define RANKMAP4D_TABLE_VERSION      1
+#define RANKMAP4D_TABLE_ENDIAN       0x01020304u
+#define RANKMAP4D_TABLE_HEADER_SIZE  128
+
+// the rankid order (as --order= in calc_rankid_order.c)
+#define RANKMAP4D_TABLE_ORDER_CUSTOM   -1
+#define RANKMAP4D_TABLE_ORDER_LEX       0
+#define RANKMAP4D_TABLE_ORDER_REVERSED  1
+#define RANKMAP4D_TABLE_ORDER_BLOCKED   2
+#define RANKMAP4D_TABLE_ORDER_MORTON    3
+#define RANKMAP4D_TABLE_ORDER_HILBERT   4
+
+typedef struct {
+  char     magic[8];       // RANKMAP4D_TABLE_MAGIC (without '\0')
+  uint32_t version;
+  uint32_t endian;         // RANKMAP4D_TABLE_ENDIAN
+  uint32_t header_size;    // offset of the first entry
+  uint32_t entry_size;     // sizeof(rankmap4d_table_entry)
+  int32_t  np;
+  int32_t  order;          // RANKMAP4D_TABLE_ORDER_*
+  int32_t  psize[4];       // process lattice
+  int32_t  shape[3];       // node shape
+  int32_t  periodic[3];    // periodicity of the node axes
+  int32_t  reserved[14];   // 0
+} rankmap4d_table_header;
+
+// the header must be RANKMAP4D_TABLE_HEADER_SIZE bytes
+typedef char rankmap4d_table_header_check[(sizeof(rankmap4d_table_header) == RANKMAP4D_TABLE_HEADER_SIZE) ? 1 : -1];
+
+typedef struct {
+  int32_t coords[4];       // 4-dim process coordinate
+  int32_t node[3];         // 3-dim node coordinate
+  int32_t neighbor[8];     // rankid of the neighbor in each direction
+  uint8_t hop[8];          // hop distance to the neighbor
+} rankmap4d_table_entry;
+
+
+/********************************************************
+ * accessors
+ *   rankmap4d_table_open() returns NULL if the file is not
+ *   a table of this version
+ ********************************************************/
+static inline const rankmap4d_table_header *rankmap4d_table_open(const char *filename, size_t *size){
+  int fd=open(filename, O_RDONLY);
+  if(fd<0){ return NULL; }
+  struct stat st;
+  if(fstat(fd, &st) != 0 || (size_t)st.st_size < RANKMAP4D_TABLE_HEADER_SIZE){
+    close(fd);
+    return NULL;
+  }
+  void *p=mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if(p == MAP_FAILED){ return NULL; }
+  const rankmap4d_table_header *t=(const rankmap4d_table_header *)p;
+  if(memcmp(t->magic, RANKMAP4D_TABLE_MAGIC, 8) != 0 || t->version != RANKMAP4D_TABLE_VERSION
+     || t->endian != RANKMAP4D_TABLE_ENDIAN || t->entry_size != sizeof(rankmap4d_table_entry)
+     || (size_t)st.st_size < t->header_size + (size_t)t->np*t->entry_size){
+    munmap(p, st.st_size);
+    return NULL;
+  }
+  *size=st.st_size;
+  return t;
+}
+
+static inline void rankmap4d_table_close(const rankmap4d_table_header *t, const size_t size){
+  munmap((void *)t, size);
+}
+
+static inline const rankmap4d_table_entry *rankmap4d_table_entry_of(const rankmap4d_table_header *t,
+                                                                     const int rank){
+  return (const rankmap4d_table_entry *)((const char *)t + t->header_size) + rank;
+}
+
+static inline int rankmap4d_table_neighbor(const rankmap4d_table_header *t, const int rank, const int dir){
+  return rankmap4d_table_entry_of(t, rank)->neighbor[dir];
+}
+
+static inline int rankmap4d_table_hop(const rankmap4d_table_header *t, const int rank, const int dir){
+  return rankmap4d_table_entry_of(t, rank)->hop[dir];
+}
+
+static inline const int32_t *rankmap4d_table_coords(const rankmap4d_table_header *t, const int rank){
+  return rankmap4d_table_entry_of(t, rank)->coords;
+}
+
+// rankid of the coordinate, as calc_rankid(); -1 for the other orders
+//   (the rankid of the neighbors is in the table)
+static inline int rankmap4d_table_rankid(const rankmap4d_table_header *t, const int *coords){
+  const int32_t *p=t->psize;
+  if(t->order == RANKMAP4D_TABLE_ORDER_LEX){
+    return coords[0] + p[0]*(coords[1] + p[1]*(coords[2] + p[2]*coords[3]));
+  }
+  if(t->order == RANKMAP4D_TABLE_ORDER_REVERSED){
+    return coords[3] + p[3]*(coords[2] + p[2]*(coords[1] + p[1]*coords[0]));
+  }
+  return -1;
+}
+
+#endif
@@ -0,0 +1,123 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+    2026 Oct. 17 the rankid order at run time (--order=)
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "config.h"
+#include "rankmap_analyze.h"
+#include "rankmap_option.h"
+
+// defined in calc_rankid.c
+extern const char* rankmap_name;
+int select_rankmap_order(const char *name);
+
+
+void show_usage(char const * const *argv){
+    printf("usage: %s P1 P2 P3 P4 [file [PP1 PP2 PP3]] [--order=NAME] [--mesh=AXES]\n", argv[0]);
+    printf("       P1,P2,P3,P4: total process lattice\n");
+    printf("       file:        rankmap file (default: %s)\n", RANK_MAP_FILE);
+    printf("       PP1,PP2,PP3: node shape (default: the largest coordinate + 1)\n");
+    printf("       --mesh=AXES: non-periodic node axes, e.g. --mesh=xz (default: none)\n");
+    printf("       --order=NAME: rankid order: lex, reversed, blocked:B1xB2xB3xB4, morton or hilbert\n");
+    printf("  ex. %s 8 4 4 4 rankmap_4d_list.txt 8 2 2\n", argv[0]);
+}
+
+
+int main(int argc, char** argv){
+  rankmap_option opt;
+  int bad=get_option(&opt, &argc, argv);
+  if(bad){
+    printf("unknown or bad option: %s\n", argv[bad]);
+    show_usage((char const * const *)argv);
+    exit(EXIT_FAILURE);
+  }
+  if(opt.order && select_rankmap_order(opt.order)){
+    printf("unknown rankid order: %s\n", opt.order);
+    show_usage((char const * const *)argv);
+    exit(EXIT_FAILURE);
+  }
+  if(argc<5){
+    show_usage((char const * const *)argv);
+    exit(EXIT_FAILURE);
+  }
+  int psize[4];
+  for(int i=0; i<4; i++){
+    psize[i]=atoi(argv[i+1]);
+    if(psize[i]<1){
+      fprintf(stderr, "bad process size: P%d=%d\n", i+1, psize[i]);
+      exit(EXIT_FAILURE);
+    }
+  }
+  const char *filename = (argc>5) ? argv[5] : RANK_MAP_FILE;
+
+  int np=psize[0]*psize[1]*psize[2]*psize[3];
+  int *rank_list=malloc(sizeof(int)*3*np);
+  if(read_rankmap(rank_list, np, filename)){
+    exit(EXIT_FAILURE);
+  }
+
+  int shape[3]={0,0,0};
+  if(argc>8){
+    for(int i=0; i<3; i++){
+      shape[i]=atoi(argv[i+6]);
+    }
+  } else {
+    for(int n=0; n<np; n++){
+      for(int i=0; i<3; i++){
+        if(rank_list[3*n+i]+1 > shape[i]){
+          shape[i]=rank_list[3*n+i]+1;
+        }
+      }
+    }
+  }
+  for(int n=0; n<np; n++){
+    for(int i=0; i<3; i++){
+      int c=rank_list[3*n+i];
+      if(c<0 || c>=shape[i]){
+        fprintf(stderr, "out of the node shape: rank %d, (%d,%d,%d)\n",
+                n, rank_list[3*n], rank_list[3*n+1], rank_list[3*n+2]);
+        exit(EXIT_FAILURE);
+      }
+    }
+  }
+  int periodic[3];
+  for(int i=0; i<3; i++){
+    periodic[i] = (opt.periodic[i]<0) ? 1 : opt.periodic[i];
+  }
+
+  printf("rankmap file: %s\n", filename);
+  printf("using rankmap: %s\n", rankmap_name);
+  int bad_rank=check_rank_order(psize);
+  if(bad_rank != -1){
+    if(bad_rank>=0){
+      fprintf(stderr, "%s is not a bijection on the process lattice: rank %d\n", rankmap_name, bad_rank);
+    }
+    exit(EXIT_FAILURE);
+  }
+  halo_stat stat;
+  analyze_halo(&stat, rank_list, psize, shape, periodic);
+  print_halo_stat(stdout, &stat);
+  free_halo_stat(&stat);
+
+  free(rank_list);
+  return 0;
+}
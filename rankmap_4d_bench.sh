@@ -0,0 +1,133 @@
+#!/bin/sh
+# Copyright (c) 2020-2023 Issaku Kanamori <kanamori-i@riken.jp>
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation; either version 3
+# of the License, or any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program. If not, see http://www.gnu.org/licenses/.
+#
+# See the full license in the file "LICENSE".
+#
+#   2026 Oct. 17 the first version
+#
+# scaling benchmark of the generators (make bench)
+#
+#   usage: ./rankmap_4d_bench.sh [case_file] > rankmap_4d_bench.csv
+#
+# Each line of case_file is "P1 P2 P3 P4 p1 p2 p3 p4 PP1 PP2 PP3"
+# (4 processes per node; '#' starts a comment).  For each case,
+#   rankmap_4d_offline_lex   always,
+#   rankmap_4d_general_lex   if np <= BENCH_MPI_MAX_NP,
+#   rankmap_4d_lex           if np <= BENCH_MPI_MAX_NP and p1..p4 is 4 in one direction,
+# run with --profile --analyze --congestion on the simulated topology,
+# and one CSV line per run goes to stdout.
+# time_sec is the maximum over the ranks of the total time, which includes mpi_init_sec.
+#
+# environment:
+#   BENCH_MPI_MAX_NP  largest np launched with MPI (default: 1024, 0 for none);
+#                     the MPI generators must be built with TOPOLOGY=sim
+#   MPIRUN            MPI launcher, called as "$MPIRUN -np N prog ..." (default: mpirun)
+
+BENCH_MPI_MAX_NP=${BENCH_MPI_MAX_NP:-1024}
+MPIRUN=${MPIRUN:-mpirun}
+SRCDIR=$(cd "$(dirname "$0")" && pwd)
+
+default_cases(){
+  cat <<EOF
+# np=1,024
+8 8 4 4     1 1 1 4   8 8 4
+8 8 4 4     1 1 2 2   8 8 4
+# np=16,384
+16 16 8 8   1 1 1 4   16 16 16
+16 16 8 8   1 1 2 2   16 16 16
+# np=131,072
+32 32 16 8  1 1 4 1   32 32 32
+32 32 16 8  1 1 2 2   32 32 32
+# np=589,824
+48 32 24 16 1 1 2 2   48 32 96
+48 32 24 16 2 2 1 1   24 16 384
+EOF
+}
+
+# "name": {"min": ., "max": X, ...} in the profile report
+profile_max(){
+  sed -n "s/.*\"$1\": {\"min\": [^,]*, \"max\": \([^,]*\),.*/\1/p" rankmap_4d_profile.json
+}
+
+# the same for a phase
+phase_max(){
+  sed -n "s/.*\"name\": \"$1\", \"time_sec\": {\"min\": [^,]*, \"max\": \([^,]*\),.*/\1/p" rankmap_4d_profile.json
+}
+
+# one CSV line from the output of a generator in the current directory
+#   $1: generator, $2: np, $3: psize, $4: intra, $5: shape, $6: exit status, $7: log
+print_result(){
+  if [ "$6" -ne 0 ] || [ ! -f rankmap_4d_profile.json ]; then
+    echo "$1,$2,$3,$4,$5,failed,,,,,,,"
+    echo "rankmap_4d_bench: $1 $3 $4 on $5 failed (see below)" >&2
+    tail -5 "$7" >&2
+    return
+  fi
+  time_sec=$(profile_max total_time_sec)
+  init_sec=$(phase_max mpi_init)
+  rss_kb=$(profile_max peak_rss_kb)
+  out_bytes=$(wc -c < rankmap_4d_list.txt | tr -d ' ')
+  hop=$(awk '$1=="all" && NF==5 {print $2 "," $3 "," $5}' "$7" | sed 's/%//')
+  load=$(awk '$1=="max" && $2=="load:" {print $3}' "$7")
+  echo "$1,$2,$3,$4,$5,$time_sec,$init_sec,$rss_kb,$out_bytes,$hop,$load"
+}
+
+
+if [ $# -gt 0 ]; then
+  CASES=$(grep -v '^#' "$1")
+else
+  CASES=$(default_cases | grep -v '^#')
+fi
+
+WORK=$(mktemp -d "${TMPDIR:-/tmp}/rankmap_4d_bench.XXXXXX") || exit 1
+trap 'rm -rf "$WORK"' EXIT
+cd "$WORK" || exit 1
+
+echo "generator,np,psize,intra,shape,time_sec,mpi_init_sec,peak_rss_kb,output_bytes,max_hop,mean_hop,inter_node_percent,max_link_load"
+echo "$CASES" | while read -r P1 P2 P3 P4 p1 p2 p3 p4 PP1 PP2 PP3; do
+  [ -z "$PP3" ] && continue
+  np=$((P1*P2*P3*P4))
+  psize="${P1}x${P2}x${P3}x${P4}"
+  intra="${p1}x${p2}x${p3}x${p4}"
+  shape="${PP1}x${PP2}x${PP3}"
+  echo "rankmap_4d_bench: $psize / $intra on $shape" >&2
+
+  rm -f rankmap_4d_profile.json rankmap_4d_list.txt
+  "$SRCDIR/rankmap_4d_offline_lex" $P1 $P2 $P3 $P4 $p1 $p2 $p3 $p4 $PP1 $PP2 $PP3 \
+      --profile --analyze --congestion < /dev/null > log.txt 2>&1
+  print_result rankmap_4d_offline_lex $np $psize $intra $shape $? log.txt
+
+  [ "$np" -le "$BENCH_MPI_MAX_NP" ] || continue
+
+  rm -f rankmap_4d_profile.json rankmap_4d_list.txt
+  RANKMAP_SIM_SHAPE=$shape $MPIRUN -np $np "$SRCDIR/rankmap_4d_general_lex" \
+      $P1 $P2 $P3 $P4 $p1 $p2 $p3 $p4 --profile --analyze --congestion < /dev/null > log.txt 2>&1
+  print_result rankmap_4d_general_lex $np $psize $intra $shape $? log.txt
+
+  # rankmap_4d: all the processes of a node are in one direction
+  dir=0
+  case "$intra" in
+    4x1x1x1) dir=1 ;;
+    1x4x1x1) dir=2 ;;
+    1x1x4x1) dir=3 ;;
+    1x1x1x4) dir=4 ;;
+  esac
+  [ "$dir" -gt 0 ] || continue
+  rm -f rankmap_4d_profile.json rankmap_4d_list.txt
+  RANKMAP_SIM_SHAPE=$shape $MPIRUN -np $np "$SRCDIR/rankmap_4d_lex" \
+      $P1 $P2 $P3 $P4 $dir --profile --analyze --congestion < /dev/null > log.txt 2>&1
+  print_result rankmap_4d_lex $np $psize $intra $shape $? log.txt
+done
@@ -0,0 +1,170 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "rankmap_bulk.h"
+#include "rankmap_option.h"
+
+// defined in calc_rankid.c
+int calc_rankid(const int *coords, const int *psize);
+void get_rank_coord(int *coords, int rank, const int *psize);
+extern const char* rankmap_name;
+int select_rankmap_order(const char *name);
+
+
+void show_usage(char const * const *argv){
+    printf("usage: %s P1 P2 P3 P4 [repeat] [--order=NAME]\n", argv[0]);
+    printf("       P1,P2,P3,P4: total process lattice\n");
+    printf("       repeat:      number of the sweeps over all the ranks (default: 10)\n");
+    printf("       --order=NAME: rankid order: lex, reversed, blocked:B1xB2xB3xB4, morton or hilbert\n");
+    printf("  ex. %s 48 24 24 24 --order=reversed\n", argv[0]);
+}
+
+// wall clock time (clock() sums over the threads)
+static double wtime(void){
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + 1.0e-9*ts.tv_nsec;
+}
+
+
+int main(int argc, char** argv){
+  rankmap_option opt;
+  int bad=get_option(&opt, &argc, argv);
+  if(bad){
+    printf("unknown or bad option: %s\n", argv[bad]);
+    show_usage((char const * const *)argv);
+    exit(EXIT_FAILURE);
+  }
+  if(opt.order && select_rankmap_order(opt.order)){
+    printf("unknown rankid order: %s\n", opt.order);
+    show_usage((char const * const *)argv);
+    exit(EXIT_FAILURE);
+  }
+  if(argc<5){
+    show_usage((char const * const *)argv);
+    exit(EXIT_FAILURE);
+  }
+  int psize[4];
+  for(int i=0; i<4; i++){
+    psize[i]=atoi(argv[i+1]);
+    if(psize[i]<1){
+      fprintf(stderr, "bad process size: P%d=%d\n", i+1, psize[i]);
+      exit(EXIT_FAILURE);
+    }
+  }
+  int repeat = (argc>5) ? atoi(argv[5]) : 10;
+  if(repeat<1){ repeat=1; }
+  int np=psize[0]*psize[1]*psize[2]*psize[3];
+  int threads=1;
+#ifdef _OPENMP
+  threads=omp_get_max_threads();
+#endif
+
+  rankid_bulk bulk;
+  rankid_bulk_init(&bulk, psize);
+  printf("rankid engine: %dx%dx%dx%d processes (%d ranks), %s, %s, %d thread(s)\n",
+         psize[0], psize[1], psize[2], psize[3], np, rankmap_name,
+         (bulk.kind == RANKID_BULK_MIXED_RADIX) ? "mixed radix" : "scalar fallback", threads);
+
+  int *rank=malloc(sizeof(int)*np);
+  int *rank_bulk=malloc(sizeof(int)*np);
+  int *buf=malloc(sizeof(int)*8*np);
+  coords_soa coords, coords_bulk;
+  for(int mu=0; mu<4; mu++){
+    coords.c[mu]=buf+mu*np;
+    coords_bulk.c[mu]=buf+(4+mu)*np;
+  }
+  for(int r=0; r<np; r++){
+    rank[r]=r;
+  }
+
+  // warm up: the first touch of the buffers
+  get_rank_coord_bulk(&bulk, &coords, rank, np);
+  get_rank_coord_bulk(&bulk, &coords_bulk, rank, np);
+  calc_rankid_bulk(&bulk, rank_bulk, &coords_bulk, np);
+
+  // get_rank_coord
+  double t0=wtime();
+  for(int n=0; n<repeat; n++){
+    for(int r=0; r<np; r++){
+      int c[4];
+      get_rank_coord(c, rank[r], psize);
+      for(int mu=0; mu<4; mu++){
+        coords.c[mu][r]=c[mu];
+      }
+    }
+  }
+  double t_get=wtime()-t0;
+  t0=wtime();
+  for(int n=0; n<repeat; n++){
+    get_rank_coord_bulk(&bulk, &coords_bulk, rank, np);
+  }
+  double t_get_bulk=wtime()-t0;
+
+  // calc_rankid
+  t0=wtime();
+  for(int n=0; n<repeat; n++){
+    for(int r=0; r<np; r++){
+      int c[4]={coords.c[0][r], coords.c[1][r], coords.c[2][r], coords.c[3][r]};
+      rank[r]=calc_rankid(c, psize);
+    }
+  }
+  double t_calc=wtime()-t0;
+  t0=wtime();
+  for(int n=0; n<repeat; n++){
+    calc_rankid_bulk(&bulk, rank_bulk, &coords_bulk, np);
+  }
+  double t_calc_bulk=wtime()-t0;
+
+  // the bulk engine must agree with the scalar functions
+  long mismatch=0;
+  for(int r=0; r<np; r++){
+    if(rank[r] != r || rank_bulk[r] != r){
+      mismatch++;
+    }
+    for(int mu=0; mu<4; mu++){
+      if(coords.c[mu][r] != coords_bulk.c[mu][r]){
+        mismatch++;
+      }
+    }
+  }
+
+  double total=(double)np*repeat;
+  printf("  %-20s %14s %9s\n", "", "ranks/sec", "speedup");
+  printf("  %-20s %14.4e\n", "get_rank_coord", total/t_get);
+  printf("  %-20s %14.4e %8.2fx\n", "get_rank_coord_bulk", total/t_get_bulk, t_get/t_get_bulk);
+  printf("  %-20s %14.4e\n", "calc_rankid", total/t_calc);
+  printf("  %-20s %14.4e %8.2fx\n", "calc_rankid_bulk", total/t_calc_bulk, t_calc/t_calc_bulk);
+  if(mismatch){
+    printf("mismatch between the bulk and the scalar functions: %ld\n", mismatch);
+  }
+
+  free(buf);
+  free(rank_bulk);
+  free(rank);
+  return mismatch ? EXIT_FAILURE : 0;
+}
@@ -0,0 +1,122 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "rankmap_write.h"
+
+#define BENCH_FILE_FPRINTF "rankmap_bench_fprintf.txt"
+#define BENCH_FILE_BUFFER  "rankmap_bench_buffer.txt"
+
+
+void show_usage(char const * const *argv){
+    printf("usage: %s [N ...]\n", argv[0]);
+    printf("       N: number of the entries (default: 100000 600000)\n");
+    printf("  writes %s and %s in the current directory and removes them\n",
+           BENCH_FILE_FPRINTF, BENCH_FILE_BUFFER);
+}
+
+static double wtime(void){
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + 1.0e-9*ts.tv_nsec;
+}
+
+// the writer before rankmap_write.c
+static int write_fprintf(const char *filename, const int *rank_list, const int np){
+  FILE *fp=fopen(filename, "w");
+  if(!fp){
+    fprintf(stderr, "cannot open the output file: %s\n", filename);
+    return 1;
+  }
+  for(int i=0; i<np; i++){
+    fprintf(fp,"(%d,%d,%d)\n", rank_list[3*i], rank_list[3*i+1], rank_list[3*i+2]);
+  }
+  return fclose(fp) != 0;
+}
+
+// 0 if the two files are the same
+static int compare_files(const char *file1, const char *file2){
+  FILE *fp1=fopen(file1, "rb");
+  FILE *fp2=fopen(file2, "rb");
+  int diff=(!fp1 || !fp2);
+  char buf1[65536], buf2[65536];
+  while(!diff){
+    size_t n1=fread(buf1, 1, sizeof(buf1), fp1);
+    size_t n2=fread(buf2, 1, sizeof(buf2), fp2);
+    diff = (n1 != n2 || memcmp(buf1, buf2, n1) != 0);
+    if(n1==0){ break; }
+  }
+  if(fp1){ fclose(fp1); }
+  if(fp2){ fclose(fp2); }
+  return diff;
+}
+
+
+int bench(const int np){
+  // node coordinates of a 24x23x24 torus with 4 processes per node
+  int *rank_list=malloc(sizeof(int)*3*np);
+  for(int i=0; i<np; i++){
+    int node=i/4;
+    rank_list[3*i  ]=node%24;
+    rank_list[3*i+1]=(node/24)%23;
+    rank_list[3*i+2]=node/(24*23);
+  }
+
+  double t0=wtime();
+  int err=write_fprintf(BENCH_FILE_FPRINTF, rank_list, np);
+  double t_fprintf=wtime()-t0;
+  t0=wtime();
+  err|=write_rankmap_file(BENCH_FILE_BUFFER, rank_list, np);
+  double t_buffer=wtime()-t0;
+
+  int diff=compare_files(BENCH_FILE_FPRINTF, BENCH_FILE_BUFFER);
+  printf("  %8d  %10.4f  %10.4f  %7.2fx%s\n", np, t_fprintf, t_buffer, t_fprintf/t_buffer,
+         diff ? "  (the files differ)" : "");
+  remove(BENCH_FILE_FPRINTF);
+  remove(BENCH_FILE_BUFFER);
+  free(rank_list);
+  return err || diff;
+}
+
+
+int main(int argc, char** argv){
+  static const int default_np[2]={100000, 600000};
+  printf("writing the rankmap file (sec)\n");
+  printf("  %8s  %10s  %10s  %8s\n", "entries", "fprintf", "buffered", "speedup");
+  int err=0;
+  if(argc<2){
+    for(int k=0; k<2; k++){
+      err|=bench(default_np[k]);
+    }
+  }
+  for(int k=1; k<argc; k++){
+    int n=atoi(argv[k]);
+    if(n<1){
+      show_usage((char const * const *)argv);
+      exit(EXIT_FAILURE);
+    }
+    err|=bench(n);
+  }
+  return err ? EXIT_FAILURE : 0;
+}
@@ -0,0 +1,312 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "config.h"
+#include "rankmap_analyze.h"
+#include "rankmap_congestion.h"
+#include "rankmap_option.h"
+#include "rankmap_vcoord.h"
+
+// defined in calc_rankid.c
+extern const char* rankmap_name;
+int select_rankmap_order(const char *name);
+void get_rank_coord(int *coords, int rank, const int *psize);
+
+// at most this number of the errors of each kind are printed
+#define CHECK_REPORT_MAX 10
+
+
+void show_usage(char const * const *argv){
+    printf("usage: %s P1 P2 P3 P4 [file [PP1 PP2 PP3]] [--ppn=N] [--order=NAME] [--mesh=AXES] [--lattice=LxLxLxL] [--site-bytes=N]\n", argv[0]);
+    printf("       P1,P2,P3,P4: total process lattice\n");
+    printf("       file:        vcoordfile to check (default: %s)\n", RANK_MAP_FILE);
+    printf("       PP1,PP2,PP3: node shape (default: the largest coordinate + 1)\n");
+    printf("       --ppn=N:   number of the processes in a node (default: 4)\n");
+    printf("       --order=NAME: rankid order: lex, reversed, blocked:B1xB2xB3xB4, morton or hilbert\n");
+    printf("       --mesh=AXES: non-periodic node axes, e.g. --mesh=xz (default: none)\n");
+    printf("       --lattice=LxLxLxL: global lattice size for the message size (default: 1 per message)\n");
+    printf("       --site-bytes=N: bytes of a site on the halo surface (default: 96)\n");
+    printf("  ex. %s 8 4 4 4 rankmap_4d_list.txt 8 2 2\n", argv[0]);
+}
+
+
+/********************************************************
+ * read the vcoordfile in one pass
+ *   the first np entries are kept in rank_list;
+ *   returns the number of the entries, or -1
+ ********************************************************/
+long read_vcoord(int *rank_list, const int np, const char *filename){
+  vcoord_reader r;
+  if(vcoord_open(&r, filename)){
+    return -1;
+  }
+  long n=0;
+  int c[3];
+  int rc;
+  while((rc=vcoord_next(&r, c)) == 1){
+    if(n<np){
+      rank_list[3*n  ]=c[0];
+      rank_list[3*n+1]=c[1];
+      rank_list[3*n+2]=c[2];
+    }
+    n++;
+  }
+  if(rc<0){
+    fprintf(stderr, "%s:%ld: not an entry of the form (x,y,z)\n", filename, r.line);
+    n=-1;
+  }
+  vcoord_close(&r);
+  return n;
+}
+
+
+/********************************************************
+ * number of the ranks on each node
+ *   returns the number of the errors:
+ *   out of the node shape, or more than ppn ranks on a node
+ ********************************************************/
+int check_occupancy(int *count, const int *rank_list, const int np, const int *shape, const int ppn){
+  int num_nodes=shape[0]*shape[1]*shape[2];
+  int err=0;
+  for(int i=0; i<num_nodes; i++){
+    count[i]=0;
+  }
+  for(int n=0; n<np; n++){
+    const int *c=rank_list+3*n;
+    if(c[0]>=shape[0] || c[1]>=shape[1] || c[2]>=shape[2]){
+      if(err++ < CHECK_REPORT_MAX){
+        printf("  rank %d: (%d,%d,%d) is out of the node shape\n", n, c[0], c[1], c[2]);
+      }
+      continue;
+    }
+    int node=c[0] + shape[0]*(c[1] + shape[1]*c[2]);
+    if(++count[node] == ppn+1){
+      if(err++ < CHECK_REPORT_MAX){
+        printf("  rank %d: node (%d,%d,%d) has more than %d ranks\n", n, c[0], c[1], c[2], ppn);
+      }
+    }
+  }
+
+  // histogram of the occupancy
+  int max_count=0;
+  for(int i=0; i<num_nodes; i++){
+    if(count[i]>max_count){ max_count=count[i]; }
+  }
+  int *hist=calloc(max_count+1, sizeof(int));
+  for(int i=0; i<num_nodes; i++){
+    hist[count[i]]++;
+  }
+  printf("occupancy: ranks/node  nodes\n");
+  for(int k=0; k<=max_count; k++){
+    if(hist[k]>0){
+      printf("  %10d  %6d%s\n", k, hist[k], (k>ppn) ? "  (over --ppn)" : "");
+    }
+  }
+  free(hist);
+  return err;
+}
+
+
+/********************************************************
+ * the 4-dim layout implied by the file
+ *   the ranks of a node should be a block of the process lattice,
+ *   of the same size on all the used nodes
+ *   returns 0 if so, with the block size in intra_psize
+ ********************************************************/
+int implied_layout(int *intra_psize, const int *rank_list, const int np, const int *psize,
+                   const int *shape, const int *count){
+  int num_nodes=shape[0]*shape[1]*shape[2];
+  int *box=malloc(sizeof(int)*8*num_nodes);  // min and max of the process coordinate
+  for(int i=0; i<num_nodes; i++){
+    for(int mu=0; mu<4; mu++){
+      box[8*i+mu]=psize[mu];
+      box[8*i+4+mu]=-1;
+    }
+  }
+  for(int n=0; n<np; n++){
+    const int *c=rank_list+3*n;
+    int node=c[0] + shape[0]*(c[1] + shape[1]*c[2]);
+    int coords[4];
+    get_rank_coord(coords, n, psize);
+    for(int mu=0; mu<4; mu++){
+      if(coords[mu] < box[8*node+mu]){ box[8*node+mu]=coords[mu]; }
+      if(coords[mu] > box[8*node+4+mu]){ box[8*node+4+mu]=coords[mu]; }
+    }
+  }
+
+  // the block size: the first node which is filled with a block
+  for(int mu=0; mu<4; mu++){
+    intra_psize[mu]=0;
+  }
+  for(int i=0; i<num_nodes && intra_psize[0]==0; i++){
+    int vol=1;
+    for(int mu=0; mu<4; mu++){
+      vol*=box[8*i+4+mu]-box[8*i+mu]+1;
+    }
+    if(count[i]>0 && vol==count[i]){
+      for(int mu=0; mu<4; mu++){
+        intra_psize[mu]=box[8*i+4+mu]-box[8*i+mu]+1;
+      }
+    }
+  }
+
+  int err=0;
+  int aligned=1;
+  for(int i=0; i<num_nodes; i++){
+    if(count[i]==0){ continue; }
+    int b[4];
+    int vol=1;
+    for(int mu=0; mu<4; mu++){
+      b[mu]=box[8*i+4+mu]-box[8*i+mu]+1;
+      vol*=b[mu];
+    }
+    int same=(vol==count[i]);
+    for(int mu=0; mu<4; mu++){
+      if(b[mu] != intra_psize[mu]){ same=0; }
+      if(box[8*i+mu] % b[mu] != 0){ aligned=0; }
+    }
+    if(!same && err++ < CHECK_REPORT_MAX){
+      int x=i%shape[0];
+      int y=(i/shape[0])%shape[1];
+      int z=i/(shape[0]*shape[1]);
+      printf("  node (%d,%d,%d): %d ranks in [%d..%d]x[%d..%d]x[%d..%d]x[%d..%d]\n", x, y, z, count[i],
+             box[8*i], box[8*i+4], box[8*i+1], box[8*i+5], box[8*i+2], box[8*i+6], box[8*i+3], box[8*i+7]);
+    }
+  }
+  free(box);
+  if(err==0){
+    printf("implied intra-node process lattice: %dx%dx%dx%d%s\n",
+           intra_psize[0], intra_psize[1], intra_psize[2], intra_psize[3],
+           aligned ? "" : " (not aligned to the block boundary)");
+  } else {
+    printf("implied intra-node process lattice: irregular on %d nodes\n", err);
+  }
+  return err;
+}
+
+
+int main(int argc, char** argv){
+  rankmap_option opt;
+  int bad=get_option(&opt, &argc, argv);
+  if(bad){
+    printf("unknown or bad option: %s\n", argv[bad]);
+    show_usage((char const * const *)argv);
+    exit(EXIT_FAILURE);
+  }
+  if(opt.order && select_rankmap_order(opt.order)){
+    printf("unknown rankid order: %s\n", opt.order);
+    show_usage((char const * const *)argv);
+    exit(EXIT_FAILURE);
+  }
+  if(argc<5){
+    show_usage((char const * const *)argv);
+    exit(EXIT_FAILURE);
+  }
+  int psize[4];
+  for(int i=0; i<4; i++){
+    psize[i]=atoi(argv[i+1]);
+    if(psize[i]<1){
+      fprintf(stderr, "bad process size: P%d=%d\n", i+1, psize[i]);
+      exit(EXIT_FAILURE);
+    }
+    if(opt.lattice[i] % psize[i] != 0){
+      fprintf(stderr, "P%d=%d does not divide the lattice size L%d=%d\n", i+1, psize[i], i+1, opt.lattice[i]);
+      exit(EXIT_FAILURE);
+    }
+  }
+  const char *filename = (argc>5) ? argv[5] : RANK_MAP_FILE;
+  int ppn = (opt.ppn>0) ? opt.ppn : 4;
+
+  printf("vcoordfile: %s\n", filename);
+  printf("using rankmap: %s\n", rankmap_name);
+  int bad_rank=check_rank_order(psize);
+  if(bad_rank != -1){
+    if(bad_rank>=0){
+      fprintf(stderr, "%s is not a bijection on the process lattice: rank %d\n", rankmap_name, bad_rank);
+    }
+    exit(EXIT_FAILURE);
+  }
+
+  // entries: one for each rankid
+  int np=psize[0]*psize[1]*psize[2]*psize[3];
+  int *rank_list=malloc(sizeof(int)*3*np);
+  long n=read_vcoord(rank_list, np, filename);
+  if(n<0){
+    exit(EXIT_FAILURE);
+  }
+  printf("entries: %ld (np=%d)\n", n, np);
+  if(n != np){
+    printf("error: the number of the entries must be np=P1xP2xP3xP4\n");
+    exit(EXIT_FAILURE);
+  }
+
+  int shape[3]={0,0,0};
+  if(argc>8){
+    for(int i=0; i<3; i++){
+      shape[i]=atoi(argv[i+6]);
+    }
+  } else {
+    for(int k=0; k<np; k++){
+      for(int i=0; i<3; i++){
+        if(rank_list[3*k+i]+1 > shape[i]){
+          shape[i]=rank_list[3*k+i]+1;
+        }
+      }
+    }
+  }
+  printf("node shape: %d %d %d, %d processes/node\n", shape[0], shape[1], shape[2], ppn);
+
+  // every rankid on a node in the shape, at most ppn on a node
+  int *count=malloc(sizeof(int)*shape[0]*shape[1]*shape[2]);
+  int err=check_occupancy(count, rank_list, np, shape, ppn);
+  if(err){
+    printf("error: %d ranks are out of the node shape or over --ppn=%d\n", err, ppn);
+    exit(EXIT_FAILURE);
+  }
+  printf("bijection: every rankid has its own (node, intra-node rank)\n");
+
+  // 4-dim layout reconstructed with get_rank_coord()
+  int intra_psize[4];
+  implied_layout(intra_psize, rank_list, np, psize, shape, count);
+  free(count);
+
+  // hop distance and link load of the halo exchange
+  int periodic[3];
+  for(int i=0; i<3; i++){
+    periodic[i] = (opt.periodic[i]<0) ? 1 : opt.periodic[i];
+  }
+  halo_stat stat;
+  analyze_halo(&stat, rank_list, psize, shape, periodic);
+  print_halo_stat(stdout, &stat);
+  free_halo_stat(&stat);
+
+  double msg_bytes[HALO_NDIR];
+  const char *unit=halo_message_bytes(msg_bytes, psize, opt.lattice, opt.site_bytes);
+  link_load ll;
+  simulate_links(&ll, rank_list, psize, shape, periodic, msg_bytes);
+  print_link_load(stdout, &ll, unit);
+  free_link_load(&ll);
+
+  free(rank_list);
+  return 0;
+}
@@ -0,0 +1,137 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+    2026 Oct. 17 the rankid order at run time (--order=)
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "config.h"
+#include "rankmap_analyze.h"
+#include "rankmap_congestion.h"
+#include "rankmap_option.h"
+
+// defined in calc_rankid.c
+extern const char* rankmap_name;
+int select_rankmap_order(const char *name);
+
+
+void show_usage(char const * const *argv){
+    printf("usage: %s P1 P2 P3 P4 [file [PP1 PP2 PP3]] [--order=NAME] [--mesh=AXES] [--lattice=LxLxLxL] [--site-bytes=N]\n", argv[0]);
+    printf("       P1,P2,P3,P4: total process lattice\n");
+    printf("       file:        rankmap file (default: %s)\n", RANK_MAP_FILE);
+    printf("       PP1,PP2,PP3: node shape (default: the largest coordinate + 1)\n");
+    printf("       --mesh=AXES: non-periodic node axes, e.g. --mesh=xz (default: none)\n");
+    printf("       --order=NAME: rankid order: lex, reversed, blocked:B1xB2xB3xB4, morton or hilbert\n");
+    printf("       --lattice=LxLxLxL: global lattice size for the message size (default: 1 per message)\n");
+    printf("       --site-bytes=N: bytes of a site on the halo surface (default: 96)\n");
+    printf("  ex. %s 8 4 4 4 rankmap_4d_list.txt 8 2 2 --lattice=64x32x32x32\n", argv[0]);
+}
+
+
+int main(int argc, char** argv){
+  rankmap_option opt;
+  int bad=get_option(&opt, &argc, argv);
+  if(bad){
+    printf("unknown or bad option: %s\n", argv[bad]);
+    show_usage((char const * const *)argv);
+    exit(EXIT_FAILURE);
+  }
+  if(opt.order && select_rankmap_order(opt.order)){
+    printf("unknown rankid order: %s\n", opt.order);
+    show_usage((char const * const *)argv);
+    exit(EXIT_FAILURE);
+  }
+  if(argc<5){
+    show_usage((char const * const *)argv);
+    exit(EXIT_FAILURE);
+  }
+  int psize[4];
+  for(int i=0; i<4; i++){
+    psize[i]=atoi(argv[i+1]);
+    if(psize[i]<1){
+      fprintf(stderr, "bad process size: P%d=%d\n", i+1, psize[i]);
+      exit(EXIT_FAILURE);
+    }
+    if(opt.lattice[i] % psize[i] != 0){
+      fprintf(stderr, "P%d=%d does not divide the lattice size L%d=%d\n", i+1, psize[i], i+1, opt.lattice[i]);
+      exit(EXIT_FAILURE);
+    }
+  }
+  const char *filename = (argc>5) ? argv[5] : RANK_MAP_FILE;
+
+  int np=psize[0]*psize[1]*psize[2]*psize[3];
+  int *rank_list=malloc(sizeof(int)*3*np);
+  if(read_rankmap(rank_list, np, filename)){
+    exit(EXIT_FAILURE);
+  }
+
+  int shape[3]={0,0,0};
+  if(argc>8){
+    for(int i=0; i<3; i++){
+      shape[i]=atoi(argv[i+6]);
+    }
+  } else {
+    for(int n=0; n<np; n++){
+      for(int i=0; i<3; i++){
+        if(rank_list[3*n+i]+1 > shape[i]){
+          shape[i]=rank_list[3*n+i]+1;
+        }
+      }
+    }
+  }
+  for(int n=0; n<np; n++){
+    for(int i=0; i<3; i++){
+      int c=rank_list[3*n+i];
+      if(c<0 || c>=shape[i]){
+        fprintf(stderr, "out of the node shape: rank %d, (%d,%d,%d)\n",
+                n, rank_list[3*n], rank_list[3*n+1], rank_list[3*n+2]);
+        exit(EXIT_FAILURE);
+      }
+    }
+  }
+  int periodic[3];
+  for(int i=0; i<3; i++){
+    periodic[i] = (opt.periodic[i]<0) ? 1 : opt.periodic[i];
+  }
+
+  printf("rankmap file: %s\n", filename);
+  printf("using rankmap: %s\n", rankmap_name);
+  int bad_rank=check_rank_order(psize);
+  if(bad_rank != -1){
+    if(bad_rank>=0){
+      fprintf(stderr, "%s is not a bijection on the process lattice: rank %d\n", rankmap_name, bad_rank);
+    }
+    exit(EXIT_FAILURE);
+  }
+  double msg_bytes[HALO_NDIR];
+  const char *unit=halo_message_bytes(msg_bytes, psize, opt.lattice, opt.site_bytes);
+
+  clock_t t0=clock();
+  link_load ll;
+  simulate_links(&ll, rank_list, psize, shape, periodic, msg_bytes);
+  clock_t t1=clock();
+  print_link_load(stdout, &ll, unit);
+  free_link_load(&ll);
+  printf("finished: rankmap_4d_congestion. (%.3f sec cpu)\n", (double)(t1-t0)/CLOCKS_PER_SEC);
+
+  free(rank_list);
+  return 0;
+}
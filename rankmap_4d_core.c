@@ -0,0 +1,493 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 split from rankmap_4d_general.c
+                 (shared with the offline generator)
+    2026 Oct. 17 folding of the node lattice, if it does not match
+                 the 3-dim topology
+    2026 Oct. 17 ring embedding on the non-periodic node axes
+    2026 Oct. 17 buffered writer of the rankmap file (rankmap_write.c)
+    2026 Oct. 17 find_direction_map() without abort, for the ensemble
+    2026 Oct. 17 no output to stdout in the library build
+    2026 Oct. 17 output_rankmap() without the unused process size
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "config.h"
+#include "rankmap_4d_core.h"
+#include "rankmap_write.h"
+
+
+void get_param(proc_dim *dim, const int argc, char const * const *argv, const int ppn){
+
+  int *proc=dim->psize;  // alias
+  int *intra_proc=dim->intra_psize;  // alias
+  proc[0]=atoi(argv[1]);  // px
+  proc[1]=atoi(argv[2]);  // py
+  proc[2]=atoi(argv[3]);  // pz
+  proc[3]=atoi(argv[4]);  // pt
+
+  if(np != proc[0]*proc[1]*proc[2]*proc[3] ){
+    if(myrank==0){
+      printf("np=%d != P1 x P2 x P3 x P4\n", np);
+      printf("P1,P2,P3,P4=%d,%d,%d,%d\n",proc[0], proc[1], proc[2], proc[3]);
+    }
+    safe_abort(EXIT_FAILURE);
+  }
+  dim->ppn=ppn;
+  dim->fold.type=FOLD_NONE;
+  dim->physical=0;
+  dim->fallback_time=0.0;
+  dim->fallback=0;
+  for(int i=0; i<3; i++){
+    dim->periodic[i]=-1;
+  }
+  for(int i=0; i<4; i++){
+    dim->lattice[i]=0;
+  }
+
+  if(argc<9){
+    // to be determined by the automatic search
+    for(int i=0; i<4; i++){
+      intra_proc[i]=0;
+    }
+    dim->notofu_dir=-1;
+    return;
+  }
+  intra_proc[0]=atoi(argv[5]);  // px
+  intra_proc[1]=atoi(argv[6]);  // py
+  intra_proc[2]=atoi(argv[7]);  // pz
+  intra_proc[3]=atoi(argv[8]);  // pt
+
+  if(ppn != intra_proc[0]*intra_proc[1]*intra_proc[2]*intra_proc[3] ){
+    if(myrank==0){
+      printf("ranks per node=%d != p1 x p2 x p3 x p4\n", ppn);
+      printf("p1,p2,p3,p4=%d,%d,%d,%d\n",intra_proc[0], intra_proc[1], intra_proc[2], intra_proc[3]);
+    }
+    safe_abort(EXIT_FAILURE);
+  }
+
+  int node_size[4];
+  int dir=-1;
+  for(int i=0; i<4; i++){
+    if(intra_proc[i]<1 || proc[i] % intra_proc[i] != 0){
+      if(myrank==0){
+        printf("p%d=%d does not divide P%d=%d\n", i+1, intra_proc[i], i+1, proc[i]);
+      }
+      safe_abort(EXIT_FAILURE);
+    }
+    node_size[i] = proc[i]/intra_proc[i];
+    if(node_size[i]==1){
+      dir=i;
+    }
+  }
+  // dir=-1: none of the node lattice size is 1,
+  //         and only the folding of two directions on an axis is possible
+  assert(dir == -1 || dir == 0 || dir == 1 || dir == 2 || dir == 3);
+  dim->notofu_dir=dir;
+  return;
+}
+
+
+
+// returns 1 if the node lattice matches the 3-dim topology with the given notofu direction
+static int match_direction_map(int *dirmap, const proc_dim *dim, const int notofu_dir, const int *shape_fjmpi){
+  int flag[4]={0};
+  if(notofu_dir<0){ return 0; }
+  for(int i=0; i<4; i++){
+    if(i==notofu_dir){
+      dirmap[i]=3;
+      flag[3]++;
+      continue;
+    }
+    for(int fjdir=0; fjdir<3; fjdir++){
+      if(flag[fjdir]>0){ continue; }
+      if(dim->psize[i]/dim->intra_psize[i] == shape_fjmpi[fjdir]){
+        dirmap[i]=fjdir;
+        flag[fjdir]++;
+        break;
+      }
+    }
+  }
+  return (flag[0]*flag[1]*flag[2]*flag[3] == 1);
+}
+
+
+/********************************************************
+ * folding of the node lattice
+ *   split: a direction of size PPa x PPb runs on the axes
+ *          a (inner) and b (outer) as a snake; the neighbors
+ *          are 1 hop (2 hops at the wrap around if PPb is odd)
+ *   merge: two directions of size n_in x n_out share an axis;
+ *          the inner one is placed as 0,n-1,1,n-2,... to keep
+ *          the neighbors within 2 hops, and the outer one is
+ *          n_in hops
+ *   the other directions must match the remaining axes or be 1
+ ********************************************************/
+// assigns the directions which are not folded; returns 1 if success
+static int match_rest(int *dirmap, const int *node_size, const int *folded,
+                      const int *used_axis, const int *shape_fjmpi){
+  int flag[3];
+  for(int fjdir=0; fjdir<3; fjdir++){
+    flag[fjdir]=used_axis[fjdir];
+  }
+  for(int i=0; i<4; i++){
+    if(folded[i]){
+      dirmap[i]=DIR_FOLDED;
+      continue;
+    }
+    dirmap[i]=3;
+    for(int fjdir=0; fjdir<3; fjdir++){
+      if(!flag[fjdir] && node_size[i] == shape_fjmpi[fjdir]){
+        dirmap[i]=fjdir;
+        flag[fjdir]=1;
+        break;
+      }
+    }
+    if(dirmap[i]==3 && node_size[i]!=1){ return 0; }
+  }
+  for(int fjdir=0; fjdir<3; fjdir++){
+    if(!flag[fjdir] && shape_fjmpi[fjdir]!=1){ return 0; }
+  }
+  return 1;
+}
+
+// returns 1 if found; the one with the smallest max hop is taken
+static int match_fold(int *dirmap, proc_dim *dim, const int *shape_fjmpi){
+  int node_size[4];
+  for(int i=0; i<4; i++){
+    node_size[i]=dim->psize[i]/dim->intra_psize[i];
+  }
+
+  int best_hop=0;
+  int map[4];
+  for(int d=0; d<4; d++){
+    int folded[4]={0,0,0,0};
+    folded[d]=1;
+
+    // split
+    for(int a=0; a<3; a++){
+      for(int b=0; b<3; b++){
+        if(a==b || shape_fjmpi[a]<2 || shape_fjmpi[b]<2){ continue; }
+        if(node_size[d] != shape_fjmpi[a]*shape_fjmpi[b]){ continue; }
+        int used_axis[3]={0,0,0};
+        used_axis[a]=used_axis[b]=1;
+        if(!match_rest(map, node_size, folded, used_axis, shape_fjmpi)){ continue; }
+        int hop=(shape_fjmpi[b]%2==0) ? 1 : 2;
+        if(best_hop==0 || hop<best_hop){
+          best_hop=hop;
+          for(int i=0; i<4; i++){ dirmap[i]=map[i]; }
+          dim->fold.type=FOLD_SPLIT;
+          dim->fold.dir[0]=d;
+          dim->fold.dir[1]=-1;
+          dim->fold.axis[0]=a;
+          dim->fold.axis[1]=b;
+          dim->fold.inner=shape_fjmpi[a];
+        }
+      }
+    }
+
+    // merge with the outer direction e
+    for(int e=0; e<4; e++){
+      if(e==d || node_size[d]<2 || node_size[e]<2){ continue; }
+      folded[e]=1;
+      for(int a=0; a<3; a++){
+        if(node_size[d]*node_size[e] != shape_fjmpi[a]){ continue; }
+        int used_axis[3]={0,0,0};
+        used_axis[a]=1;
+        if(!match_rest(map, node_size, folded, used_axis, shape_fjmpi)){ continue; }
+        int hop=node_size[d];
+        if(best_hop==0 || hop<best_hop){
+          best_hop=hop;
+          for(int i=0; i<4; i++){ dirmap[i]=map[i]; }
+          dim->fold.type=FOLD_MERGE;
+          dim->fold.dir[0]=d;
+          dim->fold.dir[1]=e;
+          dim->fold.axis[0]=a;
+          dim->fold.axis[1]=-1;
+          dim->fold.inner=node_size[d];
+        }
+      }
+      folded[e]=0;
+    }
+  } // d
+
+  if(best_hop==0){
+    return 0;
+  }
+  dim->notofu_dir=-1;
+  for(int i=3; i>=0; i--){
+    if(dirmap[i]==3){ dim->notofu_dir=i; }
+  }
+  return 1;
+}
+
+
+int find_direction_map(int *dirmap, proc_dim *dim, const int *shape_fjmpi){
+  // dirmap[dir]      (dir: 0--3) 
+  //   = 3   if dir is the notofu direction
+  //  or
+  //   = ( direction in the given 3-dim topology: 0-2)
+  //  or
+  //   = DIR_FOLDED  (see dim->fold)
+  dim->fold.type=FOLD_NONE;
+  int found=match_direction_map(dirmap, dim, dim->notofu_dir, shape_fjmpi);
+
+  // try the other directions of which node lattice size is 1
+  for(int i=3; i>=0 && !found; i--){
+    if(i==dim->notofu_dir || dim->psize[i] != dim->intra_psize[i]){ continue; }
+    found=match_direction_map(dirmap, dim, i, shape_fjmpi);
+    if(found){
+      dim->notofu_dir=i;
+    }
+  }
+
+  // fold a direction, if the node lattice does not match the topology
+  if(!found){
+    found=match_fold(dirmap, dim, shape_fjmpi);
+  }
+  return found;
+}
+
+
+void set_direction_map(int *dirmap, proc_dim *dim, const int *shape_fjmpi){
+  int found=find_direction_map(dirmap, dim, shape_fjmpi);
+
+  // sanity check
+  if(!found){
+
+    if(myrank==0){
+      fprintf(stderr, "something is wrong in the process size, cannot map the process to the given topology\n");
+      fprintf(stderr, " required 4-dim process size: %d %d %d %d\n",
+              dim->psize[0], dim->psize[1], dim->psize[2], dim->psize[3]);
+      fprintf(stderr, " intra-node 4-dim process size: %d %d %d %d\n",
+              dim->intra_psize[0], dim->intra_psize[1], dim->intra_psize[2], dim->intra_psize[3]);
+      fprintf(stderr, " 3-dim node shape: %d %d %d\n", shape_fjmpi[0], shape_fjmpi[1], shape_fjmpi[2]);
+    }
+    safe_abort(EXIT_FAILURE);
+  }
+#ifndef RANKMAP4D_LIBRARY  // stdout belongs to the application
+  if(myrank==0 && dim->fold.type != FOLD_NONE){
+    print_fold(stdout, dim);
+  }
+#endif
+}
+
+
+void print_fold(FILE *fp, const proc_dim *dim){
+  const char axis[3]={'x','y','z'};
+  const fold_map *fold=&dim->fold;
+  if(fold->type == FOLD_SPLIT){
+    fprintf(fp, "folding: direction %d (node lattice size %d) is split to the axes %c (inner) and %c (outer)\n",
+            fold->dir[0]+1, dim->psize[fold->dir[0]]/dim->intra_psize[fold->dir[0]],
+            axis[fold->axis[0]], axis[fold->axis[1]]);
+  } else if(fold->type == FOLD_MERGE){
+    fprintf(fp, "folding: directions %d (inner, node lattice size %d) and %d (outer, size %d) are merged to the axis %c\n",
+            fold->dir[0]+1, fold->inner,
+            fold->dir[1]+1, dim->psize[fold->dir[1]]/dim->intra_psize[fold->dir[1]],
+            axis[fold->axis[0]]);
+  }
+}
+
+
+/********************************************************
+ * 4-dim process coordinate
+ *   from the 3-dim node coordinate and the intra-node rank
+ *   N.B. coords_fjmpi[dirmap[i]] is not used for the
+ *        notofu direction (dirmap[i]=3)
+ *        and the folded directions (dirmap[i]=DIR_FOLDED)
+ ********************************************************/
+void calc_proc_coords(int *coords, const int *coords_fjmpi, const int intra_rank,
+                      const int *dirmap, const proc_dim *dim){
+  int intra_coords[4];
+  int tmp = intra_rank;
+  intra_coords[0] = tmp % dim->intra_psize[0];
+  tmp /= dim->intra_psize[0];
+  intra_coords[1] = tmp % dim->intra_psize[1];
+  tmp /= dim->intra_psize[1];
+  intra_coords[2] = tmp % dim->intra_psize[2];
+  tmp /= dim->intra_psize[2];
+  intra_coords[3] = tmp;
+
+  int node_coords[4];
+  for(int i=0; i<4; i++){
+    node_coords[i] = (dirmap[i]<3) ? coords_fjmpi[dirmap[i]] : 0;
+    if(dirmap[i]<3 && dim->periodic[dirmap[i]]==0){
+      node_coords[i] = ring_coord(node_coords[i], dim->psize[i]/dim->intra_psize[i]);
+    }
+  }
+  const fold_map *fold=&dim->fold;
+  if(fold->type == FOLD_SPLIT){
+    // snake: the inner axis is reversed on the odd outer coordinate
+    int inner=coords_fjmpi[fold->axis[0]];
+    int outer=coords_fjmpi[fold->axis[1]];
+    if(outer%2==1){
+      inner=fold->inner-1-inner;
+    }
+    node_coords[fold->dir[0]]=fold->inner*outer + inner;
+  } else if(fold->type == FOLD_MERGE){
+    int pos=coords_fjmpi[fold->axis[0]] % fold->inner;
+    node_coords[fold->dir[0]]=ring_coord(pos, fold->inner);
+    node_coords[fold->dir[1]]=coords_fjmpi[fold->axis[0]] / fold->inner;
+  }
+
+  for(int i=0; i<4; i++){
+    coords[i] =  dim->intra_psize[i]*node_coords[i] + intra_coords[i];
+  }
+}
+
+
+/********************************************************
+ * ring embedding on a line of n nodes
+ *   the coordinate at the position pos, for the placement
+ *   0,n-1,1,n-2,... (i.e., the coordinate c is placed at
+ *   0,2,4,...,5,3,1), so that the neighbors in the periodic
+ *   coordinate, including the wrap around, are within 2 hops
+ ********************************************************/
+int ring_coord(const int pos, const int n){
+  return (pos%2==0) ? pos/2 : n-1-pos/2;
+}
+
+
+// fills the periodicity of the node axes not known yet with the given one
+void set_periodic(proc_dim *dim, const int *given){
+  for(int i=0; i<3; i++){
+    if(dim->periodic[i]<0){
+      dim->periodic[i]=given[i];
+    }
+  }
+#ifndef RANKMAP4D_LIBRARY
+  if(myrank==0 && !(dim->periodic[0] && dim->periodic[1] && dim->periodic[2])){
+    printf("non-periodic node axes:%s%s%s\n",
+           dim->periodic[0] ? "" : " x", dim->periodic[1] ? "" : " y", dim->periodic[2] ? "" : " z");
+  }
+#endif
+}
+
+
+// global lattice size, which must be divided by the process size
+void set_lattice(proc_dim *dim, const int *lattice, const int site_bytes){
+  for(int i=0; i<4; i++){
+    dim->lattice[i]=lattice[i];
+    if(lattice[i]>0 && lattice[i] % dim->psize[i] != 0){
+      if(myrank==0){
+        printf("P%d=%d does not divide the lattice size L%d=%d\n", i+1, dim->psize[i], i+1, lattice[i]);
+      }
+      safe_abort(EXIT_FAILURE);
+    }
+  }
+  dim->site_bytes=site_bytes;
+}
+
+
+void print_placement(FILE *fp, const proc_dim *dim){
+  fprintf(fp, "placement: intra-node process lattice %dx%dx%dx%d, local lattice %dx%dx%dx%d, inter-node directions:",
+          dim->intra_psize[0], dim->intra_psize[1], dim->intra_psize[2], dim->intra_psize[3],
+          dim->lattice[0]/dim->psize[0], dim->lattice[1]/dim->psize[1],
+          dim->lattice[2]/dim->psize[2], dim->lattice[3]/dim->psize[3]);
+  for(int i=0; i<4; i++){
+    if(dim->psize[i] != dim->intra_psize[i]){
+      fprintf(fp, " %d", i+1);
+    }
+  }
+  fprintf(fp, "\n");
+}
+
+
+// lexical index of the node, or -1 if it is out of the shape
+int node_index(const int *coords_fjmpi, const int *shape_fjmpi){
+  for(int i=0; i<3; i++){
+    if(coords_fjmpi[i] < 0 || coords_fjmpi[i] >= shape_fjmpi[i]){
+      return -1;
+    }
+  }
+  return coords_fjmpi[0] + shape_fjmpi[0]*(coords_fjmpi[1] + shape_fjmpi[1]*coords_fjmpi[2]);
+}
+
+
+/********************************************************
+ * rank list from the node coordinates of all the MPI ranks
+ *   node_list[3*rank + i]: 3-dim node coordinate of MPI rank
+ *   rank_list[3*rankid + i]: 3-dim node coordinate of rankid
+ *   the intra-node rank is the order of the MPI rank in each node
+ ********************************************************/
+void build_rank_list(int *rank_list, const int *node_list, const int *shape_fjmpi,
+                     const int *dirmap, const proc_dim *dim){
+  int num_nodes=shape_fjmpi[0]*shape_fjmpi[1]*shape_fjmpi[2];
+  int *node_count=calloc(num_nodes, sizeof(int));
+  for(int i=0; i<3*np; i++){
+    rank_list[i]=-1;
+  }
+  for(int rank=0; rank<np; rank++){
+    int coords_fjmpi[4];
+    for(int i=0; i<3; i++){
+      coords_fjmpi[i]=node_list[3*rank+i];
+    }
+    coords_fjmpi[3]=0;
+    int node=node_index(coords_fjmpi, shape_fjmpi);
+    if(node < 0){ continue; } // detected by check_rank_list()
+    int intra_rank=node_count[node]++;
+    if(intra_rank >= dim->ppn){ continue; }
+
+    int coords[4];
+    calc_proc_coords(coords, coords_fjmpi, intra_rank, dirmap, dim);
+    int rankid=calc_rankid(coords, dim->psize);
+    if(rankid < 0 || rankid >= np){ continue; }
+    for(int i=0; i<3; i++){
+      rank_list[3*rankid+i]=coords_fjmpi[i];
+    }
+  }
+  free(node_count);
+}
+
+
+/********************************************************
+ * sanity check of the rank list
+ *   returns -1 if all the entries are in the node shape,
+ *   or the first rankid with a bad entry
+ ********************************************************/
+int check_rank_list(const int *rank_list, const int *shape_fjmpi){
+  for(int i=0; i<np; i++){
+    for(int dim3=0; dim3<3; dim3++){
+      int r=rank_list[3*i+dim3];
+      if(r < 0 || r >=shape_fjmpi[dim3]){
+        return i;
+      }
+    } // dim3
+  } // i
+  return -1;
+}
+
+
+/***********************************************************
+ * out put the rankmap to a file
+ *   the output filename is defined with macro
+ ***********************************************************/
+void output_rankmap(const int *rank_list){
+
+  int err=0;
+  const char *filename=RANK_MAP_FILE;
+  if(myrank==0){
+    printf("rank map file: %s\n", filename);
+    err=write_rankmap_file(filename, rank_list, np);
+  }
+  check_error(err, 0, "writing the output file");
+  return;
+}
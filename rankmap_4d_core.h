@@ -0,0 +1,111 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 split from rankmap_4d_general.c
+                 (shared with the offline generator)
+    2026 Oct. 17 folding of the node lattice
+    2026 Oct. 17 ring embedding on the non-periodic node axes
+    2026 Oct. 17 global lattice size for the halo bytes
+    2026 Oct. 17 the map on the 6-dim Tofu coordinate (--physical)
+    2026 Oct. 17 find_direction_map()
+    2026 Oct. 17 fallback mapper for the allocations without a direction map
+    2026 Oct. 17 lookup_rankmap_cache() also in the offline generator
+    2026 Oct. 17 write_profile_report() also in the offline generator
+ */
+#ifndef rankmap_4d_core_h
+#define rankmap_4d_core_h
+
+#include <stdio.h>
+#include "rankmap4d_prefix.h"
+
+/**************************************************
+
+  provided by each program (MPI or serial)
+
+**************************************************/
+extern int np;
+extern int myrank;
+
+void safe_abort_(int status, const char* file, int line);
+#define safe_abort(status) safe_abort_(status, __FILE__, __LINE__);
+void check_error(const int rc, const int success, const char* msg);
+
+// defined in calc_rankid.c
+int calc_rankid(const int *coords, const int *psize);
+void get_rank_coord(int *coords, int rank, const int *psize);
+extern const char* rankmap_name;
+int select_rankmap_order(const char *name);  // --order=NAME, 0 if success
+
+/**************************************************
+
+  the map from 3-dim node x intra-node to 4-dim
+
+**************************************************/
+#define FOLD_NONE   0
+#define FOLD_SPLIT  1   // one 4-dim direction spans two axes of the topology
+#define FOLD_MERGE  2   // two 4-dim directions share one axis of the topology
+#define DIR_FOLDED  4   // dirmap[] of the folded directions
+
+typedef struct {
+  int type;
+  int dir[2];    // split: dir[0];  merge: dir[0] (inner), dir[1] (outer)
+  int axis[2];   // split: axis[0] (inner), axis[1] (outer);  merge: axis[0]
+  int inner;     // extent of the inner part
+} fold_map;
+
+typedef struct {
+  int psize[4];
+  int intra_psize[4];
+  int notofu_dir;
+  int ppn;           // number of the processes in a node
+  fold_map fold;
+  int periodic[3];   // 1: torus, 0: mesh, -1: not known yet (node axes)
+  int lattice[4];    // global lattice size (0: not given)
+  int site_bytes;    // bytes of a site on the halo surface
+  int physical;      // 1: the node lattice folded from the 6-dim Tofu coordinate
+  double fallback_time;  // time budget of the fallback mapper in sec (0: abort if no map)
+  int fallback;      // 1: mapped by the fallback mapper (intra_psize is not used)
+} proc_dim;
+
+void get_param(proc_dim *dim, const int argc, char const * const *argv, const int ppn);
+void set_direction_map(int *dirmap, proc_dim *dim, const int *shape_fjmpi);
+int  find_direction_map(int *dirmap, proc_dim *dim, const int *shape_fjmpi);  // 1 if found
+void print_fold(FILE *fp, const proc_dim *dim);
+void calc_proc_coords(int *coords, const int *coords_fjmpi, const int intra_rank,
+                      const int *dirmap, const proc_dim *dim);
+int  ring_coord(const int pos, const int n);
+void set_periodic(proc_dim *dim, const int *given);
+void set_lattice(proc_dim *dim, const int *lattice, const int site_bytes);
+void print_placement(FILE *fp, const proc_dim *dim);
+int  node_index(const int *coords_fjmpi, const int *shape_fjmpi);
+void build_rank_list(int *rank_list, const int *node_list, const int *shape_fjmpi,
+                     const int *dirmap, const proc_dim *dim);
+int  check_rank_list(const int *rank_list, const int *shape_fjmpi);
+void output_rankmap(const int *rank_list);
+
+// defined in rankmap_4d_mpi.c (MPI programs only)
+int  detect_node_np(void);
+void set_rankmap(int *rank_list, int *tofu_rank_list, int *shape_fjmpi, proc_dim *dim, const int auto_mode);
+
+// defined in rankmap_4d_mpi.c and rankmap_4d_offline.c
+int  lookup_rankmap_cache(char *key, const char *dir, const proc_dim *dim, const int auto_mode,
+                          const int lookup);
+void write_profile_report(const char *program, const proc_dim *dim);
+
+#endif
@@ -0,0 +1,152 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+    2026 Oct. 17 reject --format=, --topology= and --fallback-time=
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <mpi.h>
+#include "config.h"
+#include "topology.h"
+#include "rankmap_option.h"
+#include "rankmap_4d_core.h"
+#include "rankmap_write.h"
+#include "rankmap_ensemble.h"
+
+// global
+int np;
+int myrank;
+
+
+void show_usage(char const * const *argv){
+    printf("usage: %s FILE [--order=NAME] [--mesh=AXES] [--analyze]\n", argv[0]);
+    printf("       FILE: ensemble file, one line for each member (or count members):\n");
+    printf("             P1 P2 P3 P4 p1 p2 p3 p4 [count]\n");
+    printf("       P1,P2,P3,P4: process lattice of the member\n");
+    printf("       p1,p2,p3,p4: intra-node process lattice (p1 x p2 x p3 x p4 = processes per node)\n");
+    printf("       --mesh=AXES: non-periodic node axes, e.g. --mesh=xz (default: given by the topology)\n");
+    printf("       --order=NAME: rankid order in each member: lex, reversed, blocked:B1xB2xB3xB4, morton or hilbert\n");
+    printf("       --analyze: print the hop distance of the halo exchange in each member\n");
+    printf("  writes %s and the member table %s\n", RANK_MAP_FILE, RANK_MAP_ENSEMBLE_FILE);
+}
+
+int main(int argc, char** argv){
+  // initialization
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
+  MPI_Comm_size(MPI_COMM_WORLD, &np);
+
+  // read options
+  rankmap_option opt;
+  int bad=get_option(&opt, &argc, argv);
+  int unsupported = opt.congestion || opt.table || opt.profile || opt.physical || opt.bind
+    || opt.auto_search || opt.lattice[0]>0 || opt.cache_dir
+    || opt.format || opt.topology || opt.fallback_given;
+  if(bad || unsupported){
+    if(myrank==0){
+      if(bad){
+        printf("unknown or bad option: %s\n", argv[bad]);
+      } else {
+        printf("the ensemble takes only --order=, --mesh=, --ppn= and --analyze\n");
+      }
+      show_usage((char const * const *)argv);
+    }
+    safe_abort(EXIT_FAILURE);
+  }
+
+  // rankid order
+  if(opt.order && select_rankmap_order(opt.order)){
+    if(myrank==0){
+      printf("unknown rankid order: %s\n", opt.order);
+      show_usage((char const * const *)argv);
+    }
+    safe_abort(EXIT_FAILURE);
+  }
+
+  if(argc<2){
+    if(myrank==0){
+      show_usage((char const * const *)argv);
+    }
+    safe_abort(EXIT_FAILURE);
+  }
+  int ppn=detect_node_np();
+  check_error(opt.ppn>0 && opt.ppn != ppn, 0, "--ppn differs from the detected processes per node");
+
+  // members (only rank 0 keeps them)
+  ensemble ens={0, 0, NULL};
+  int rc=0;
+  if(myrank==0){
+    rc=read_ensemble(&ens, argv[1], ppn);
+    if(rc<0){
+      printf("cannot read the ensemble file: %s\n", argv[1]);
+    } else if(rc>0){
+      printf("%s:%d: bad member (P1 P2 P3 P4 p1 p2 p3 p4 [count], p1 x p2 x p3 x p4 = %d)\n",
+             argv[1], rc, ppn);
+    } else if(ens.np > np){
+      printf("the ensemble has %d processes, more than np=%d\n", ens.np, np);
+      rc=1;
+    } else {
+      printf("using rankmap: %s\n", rankmap_name);
+    }
+  }
+  check_error(rc, 0, "read_ensemble");
+
+  // generate rankmap
+  int *rank_list=NULL;
+  if(myrank==0){
+    rank_list=malloc(sizeof(int)*3*ens.np);
+  }
+  int shape_fjmpi[3];
+  int periodic[3];
+  for(int i=0; i<3; i++){
+    periodic[i]=opt.periodic[i];
+  }
+  set_ensemble_rankmap(rank_list, shape_fjmpi, periodic, &ens);
+
+  // hop distance of the halo exchange
+  if(opt.analyze && myrank==0){
+    print_ensemble_halo(stdout, &ens, rank_list, shape_fjmpi, periodic);
+  }
+
+  // output the rankmap and the member table
+  if(myrank==0){
+    printf("rank map file: %s (%d ranks)\n", RANK_MAP_FILE, ens.np);
+    rc=write_rankmap_file(RANK_MAP_FILE, rank_list, ens.np);
+    if(rc==0){
+      printf("member table: %s\n", RANK_MAP_ENSEMBLE_FILE);
+      rc=write_ensemble_table(RANK_MAP_ENSEMBLE_FILE, &ens);
+    }
+  }
+  check_error(rc, 0, "writing the output file");
+
+  // reallocate
+  free(rank_list);
+  free_ensemble(&ens);
+
+  // done
+  MPI_Barrier(MPI_COMM_WORLD);
+  if(myrank==0){
+    printf("finished: rankmap_4d_ensemble.\n");
+    fflush(stdout);
+  }
+  MPI_Finalize();
+  return 0;
+}
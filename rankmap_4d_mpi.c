@@ -0,0 +1,782 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 split from rankmap_4d_general.c and rankmap_4d.c
+    2026 Oct. 17 check the round trip of the rankid order
+    2026 Oct. 17 cache of the generated rankmap (--cache=)
+    2026 Oct. 17 time and bytes of each phase (--profile)
+    2026 Oct. 17 distributed check of the bijection before collecting the map
+    2026 Oct. 17 the map on the 6-dim Tofu coordinate (--physical)
+    2026 Oct. 17 rankmap of an ensemble of process lattices
+    2026 Oct. 17 fallback mapper if the process lattice does not match the nodes
+    2026 Oct. 17 check_bijection(): a slot out of the node lattice is an error
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <mpi.h>
+#include "config.h"
+#include "topology.h"
+#include "rankmap_4d_core.h"
+#include "rankmap_auto.h"
+#include "rankmap_analyze.h"
+#include "rankmap_cache.h"
+#include "rankmap_profile.h"
+#include "rankmap_tofu.h"
+#include "rankmap_ensemble.h"
+#include "rankmap_fallback.h"
+
+/**************************************************
+
+  utility functions
+
+**************************************************/
+void safe_abort_(int status, const char* file, int line){
+  if(myrank==0){
+    printf("safe_abort is called in %s, at line %d:  status=%d\n", file, line, status);
+  }
+
+  fflush(stdout);
+  MPI_Barrier(MPI_COMM_WORLD);
+  MPI_Finalize();
+  exit(status);
+}
+
+void check_error(const int rc, const int success, const char* msg){
+  int flag=0;
+  int recv=0;
+  if(rc != success){
+    flag=1;
+  }
+  MPI_Allreduce(&flag, &recv, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+  profile_add_bytes(2*sizeof(int));
+  if(recv>0){
+    fprintf(stderr, "error at %s\n", msg);
+    safe_abort(EXIT_FAILURE);
+  }
+}
+
+
+/********************************************************
+ * collect the 3 dim coordinates of all the processes
+ *   rank_list[3*rankid + i] = coords_fjmpi[i]  (only on rank 0)
+ *
+ *   Each process sends (rankid, packed 3-dim coordinate),
+ *   i.e., 2 ints, to rank 0 with MPI_Gather.
+ *   The original MPI_Allreduce over the whole 3*np list
+ *   is available with -DRANKMAP_USE_ALLREDUCE for comparison.
+ ********************************************************/
+// each of the 3-dim coordinate is packed into COORD_BITS bits
+#define COORD_BITS 10
+#define COORD_MASK ((1<<COORD_BITS)-1)
+
+void collect_rank_list(int *rank_list, const int rankid, const int *coords_fjmpi, const int *shape_fjmpi){
+  int list_size=3*np;
+  long work_bytes=0;       // work area on rank 0
+  long work_bytes_other=0; // work area on the other ranks
+  profile_begin(PROF_COLLECT);
+  double t0=MPI_Wtime();
+
+#ifdef RANKMAP_USE_ALLREDUCE
+  // prepare the work area and set the coordiante of this process
+  int *work=malloc(sizeof(int)*list_size);
+  int *list=(myrank==0) ? rank_list : malloc(sizeof(int)*list_size);
+  for(int i=0; i<list_size; i++){
+    work[i]=0;
+  }
+  int offset=3*rankid;
+  for(int i=0; i<3; i++){
+    work[offset+i]=coords_fjmpi[i];
+  }
+
+  // obtain the coordinate of all the process
+  MPI_Allreduce(work, list, list_size, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+  profile_add_bytes(2.0*sizeof(int)*list_size);
+  free(work);
+  if(myrank!=0){
+    free(list);
+  }
+  work_bytes=2*sizeof(int)*list_size;
+  work_bytes_other=work_bytes;
+  const char *method="MPI_Allreduce";
+#else
+  // the packed coordinate must fit in an int
+  for(int i=0; i<3; i++){
+    if(shape_fjmpi[i] > COORD_MASK+1){
+      if(myrank==0){
+        fprintf(stderr, "too large node shape to pack: shape[%d]=%d (max %d)\n", i, shape_fjmpi[i], COORD_MASK+1);
+      }
+      safe_abort(EXIT_FAILURE);
+    }
+  }
+  int send[2];
+  send[0]=rankid;
+  send[1]=coords_fjmpi[0] | (coords_fjmpi[1]<<COORD_BITS) | (coords_fjmpi[2]<<(2*COORD_BITS));
+
+  int *recv=NULL;
+  if(myrank==0){
+    recv=malloc(sizeof(int)*2*np);
+  }
+  MPI_Gather(send, 2, MPI_INT, recv, 2, MPI_INT, 0, MPI_COMM_WORLD);
+  profile_add_bytes(sizeof(int)*2.0*((myrank==0) ? np+1 : 1));
+
+  // build the list only on rank 0
+  if(myrank==0){
+    for(int i=0; i<list_size; i++){
+      rank_list[i]=-1;
+    }
+    for(int i=0; i<np; i++){
+      int r=recv[2*i];
+      if(r < 0 || r >= np){ continue; } // detected as an unset entry below
+      int packed=recv[2*i+1];
+      rank_list[3*r  ]= packed                   & COORD_MASK;
+      rank_list[3*r+1]=(packed>>COORD_BITS)      & COORD_MASK;
+      rank_list[3*r+2]=(packed>>(2*COORD_BITS))  & COORD_MASK;
+    }
+    free(recv);
+  }
+  work_bytes=sizeof(int)*(2*np + list_size);
+  work_bytes_other=sizeof(int)*2;
+  const char *method="MPI_Gather";
+#endif
+  double t1=MPI_Wtime();
+  profile_end(PROF_COLLECT);
+  if(myrank==0){
+    printf("collecting the coordinates with %s: %.6f sec\n", method, t1-t0);
+    printf("  work area: %ld bytes on rank 0, %ld bytes on the other ranks\n", work_bytes, work_bytes_other);
+  }
+
+  // sanity check
+  profile_begin(PROF_CHECK);
+  int err=0;
+  if(myrank==0){
+    int i=check_rank_list(rank_list, shape_fjmpi);
+    if(i>=0){
+      fprintf(stderr, "cannot happen: i=%d, rank_list[3*i]=%d,%d,%d\n", i, rank_list[3*i], rank_list[3*i+1], rank_list[3*i+2]);
+      err=1;
+    }
+  }
+  check_error(err, 0, "collecting the rank coordinates");
+  profile_end(PROF_CHECK);
+}
+
+
+/********************************************************
+ * distributed check that the map is a bijection
+ *   key 0: rankid, which must be in 0..np-1
+ *   key 1: slot=node*ppn+intra_rank, in 0..num_nodes*ppn-1
+ *   Every key must be taken by exactly one process, and
+ *   every rankid by some process.
+ *
+ *   The key k is owned by the rank k/block: rank r owns the rankid r,
+ *   and a block of ceil(num_nodes*ppn/np) slots.  Each process puts
+ *   myrank+1 in the entry of its keys with MPI_Compare_and_swap,
+ *   which returns the process that has already taken it.
+ *   Each rank holds and scans only its own block of entries.
+ *   The offending processes are reported by rank 0.
+ *   returns the number of the errors (on all the ranks)
+ ********************************************************/
+enum {BIJECTION_OK, BIJECTION_RANGE, BIJECTION_RANKID, BIJECTION_SLOT, BIJECTION_MISSING,
+      BIJECTION_NODE};
+#define BIJECTION_REPORT_MAX 16
+
+int check_bijection(const int rankid, const int node, const int intra_rank,
+                    const int num_nodes, const int ppn){
+  const int nslot=num_nodes*ppn;
+  const int slot=(node<0 || intra_rank<0 || intra_rank>=ppn) ? -1 : node*ppn+intra_rank;
+  const int block0=1;                // rankid
+  const int block1=(nslot+np-1)/np;  // slot
+  int *table;
+  MPI_Win win;
+  MPI_Win_allocate(sizeof(int)*(block0+block1), sizeof(int), MPI_INFO_NULL, MPI_COMM_WORLD, &table, &win);
+  for(int i=0; i<block0+block1; i++){
+    table[i]=0;
+  }
+
+  // error of this process: kind, rank, the other rank, key
+  int err[4]={BIJECTION_OK, myrank, -1, -1};
+  int mark=myrank+1;
+  int zero=0;
+  int prev[2]={0, 0};
+  MPI_Win_fence(MPI_MODE_NOPRECEDE, win);
+  if(rankid < 0 || rankid >= np){
+    err[0]=BIJECTION_RANGE;
+    err[3]=rankid;
+  } else {
+    MPI_Compare_and_swap(&mark, &zero, &prev[0], MPI_INT, rankid/block0, rankid%block0, win);
+    profile_add_bytes(2*sizeof(int));
+  }
+  if(slot >= 0 && slot < nslot){
+    MPI_Compare_and_swap(&mark, &zero, &prev[1], MPI_INT, slot/block1, block0+slot%block1, win);
+    profile_add_bytes(2*sizeof(int));
+  } else if(err[0]==BIJECTION_OK){
+    err[0]=BIJECTION_NODE;
+    err[2]=node;
+    err[3]=intra_rank;
+  }
+  MPI_Win_fence(MPI_MODE_NOSUCCEED, win);
+
+  if(err[0]==BIJECTION_OK && prev[0] != 0){
+    err[0]=BIJECTION_RANKID;
+    err[2]=prev[0]-1;
+    err[3]=rankid;
+  } else if(err[0]==BIJECTION_OK && prev[1] != 0){
+    err[0]=BIJECTION_SLOT;
+    err[2]=prev[1]-1;
+    err[3]=slot;
+  }
+  // rankid in my block that no process has taken
+  for(int i=0; i<block0 && err[0]==BIJECTION_OK; i++){
+    int r=myrank*block0+i;
+    if(r < np && table[i]==0){
+      err[0]=BIJECTION_MISSING;
+      err[2]=-1;
+      err[3]=r;
+    }
+  }
+  MPI_Win_free(&win);
+
+  int nerr=0;
+  int bad=(err[0] != BIJECTION_OK);
+  MPI_Allreduce(&bad, &nerr, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+  profile_add_bytes(2*sizeof(int));
+  if(nerr==0){
+    return 0;
+  }
+
+  // only on failure: the errors of all the processes on rank 0
+  int *all=NULL;
+  if(myrank==0){
+    all=malloc(sizeof(int)*4*np);
+  }
+  MPI_Gather(err, 4, MPI_INT, all, 4, MPI_INT, 0, MPI_COMM_WORLD);
+  if(myrank==0){
+    fprintf(stderr, "the map is not a bijection: %d errors\n", nerr);
+    int count=0;
+    for(int i=0; i<np && count<BIJECTION_REPORT_MAX; i++){
+      const int *e=all+4*i;
+      switch(e[0]){
+      case BIJECTION_RANGE:
+        fprintf(stderr, "  rank %d: rankid %d is out of 0..%d\n", e[1], e[3], np-1);
+        break;
+      case BIJECTION_RANKID:
+        fprintf(stderr, "  rank %d: rankid %d is already taken by rank %d\n", e[1], e[3], e[2]);
+        break;
+      case BIJECTION_SLOT:
+        fprintf(stderr, "  rank %d: node %d, intra-node rank %d is already taken by rank %d\n",
+                e[1], e[3]/ppn, e[3]%ppn, e[2]);
+        break;
+      case BIJECTION_MISSING:
+        fprintf(stderr, "  rankid %d is not taken by any rank\n", e[3]);
+        break;
+      case BIJECTION_NODE:
+        fprintf(stderr, "  rank %d: node %d, intra-node rank %d is out of the %d nodes x %d\n",
+                e[1], e[2], e[3], num_nodes, ppn);
+        break;
+      default:
+        continue;
+      }
+      count++;
+    }
+    if(nerr > count){
+      fprintf(stderr, "  ... and %d more\n", nerr-count);
+    }
+    free(all);
+  }
+  return nerr;
+}
+
+
+/********************************************************
+ * 3 dim node coordinate of this process and the node shape
+ ********************************************************/
+void get_node_coords(int *coords_fjmpi, int *shape_fjmpi){
+  int rc;
+  int dim_fjmpi;
+  rc = topology_get_dimension(&dim_fjmpi);
+  check_error(rc, TOPOLOGY_SUCCESS, "topology_get_dimension");
+  if(dim_fjmpi != 3){
+    if(myrank == 0){
+      printf("rank topolog must be 3-dim but given dimension is %d\n", dim_fjmpi);
+    }
+    safe_abort(EXIT_FAILURE);
+  }
+
+  rc = topology_get_coords(myrank, dim_fjmpi, coords_fjmpi);
+  check_error(rc, TOPOLOGY_SUCCESS, "topology_get_coords");
+  rc = topology_get_shape(shape_fjmpi);
+  check_error(rc, TOPOLOGY_SUCCESS, "topology_get_shape");
+}
+
+
+/********************************************************
+ * intra-node rank and the number of the processes in the node
+ *   the processes on the same node are ordered by the MPI rank
+ ********************************************************/
+void get_intra_rank(int *intra_rank, int *node_np, const int *coords_fjmpi, const int *shape_fjmpi){
+  int node=node_index(coords_fjmpi, shape_fjmpi);
+  check_error(node<0, 0, "node coordinate out of the node shape");
+
+  MPI_Comm node_comm;
+  MPI_Comm_split(MPI_COMM_WORLD, node, myrank, &node_comm);
+  MPI_Comm_rank(node_comm, intra_rank);
+  MPI_Comm_size(node_comm, node_np);
+  MPI_Comm_free(&node_comm);
+}
+
+
+/********************************************************
+ * number of the processes in a node
+ *   must be the same for all the nodes
+ ********************************************************/
+int detect_node_np(void){
+  int coords_fjmpi[4]={0,0,0,0};
+  int shape_fjmpi[3];
+  get_node_coords(coords_fjmpi, shape_fjmpi);
+
+  int intra_rank;
+  int node_np;
+  get_intra_rank(&intra_rank, &node_np, coords_fjmpi, shape_fjmpi);
+
+  int min_np;
+  int max_np;
+  MPI_Allreduce(&node_np, &min_np, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+  MPI_Allreduce(&node_np, &max_np, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+  profile_add_bytes(4*sizeof(int));
+  if(min_np != max_np){
+    if(myrank==0){
+      fprintf(stderr, "the number of the processes differs among the nodes: %d -- %d\n", min_np, max_np);
+    }
+    safe_abort(EXIT_FAILURE);
+  }
+  if(myrank==0){
+    printf("processes per node: %d\n", node_np);
+  }
+  return node_np;
+}
+
+
+/********************************************************
+ * automatic search of the map
+ *   rank 0 collects the node coordinates of all the ranks,
+ *   evaluates all the candidates, and broadcasts the best one
+ *   returns 0 if there is no candidate and the fallback mapper is enabled
+ ********************************************************/
+int search_map(int *dirmap, proc_dim *dim, const int *coords_fjmpi, const int *shape_fjmpi, const int mode){
+  int *node_list=NULL;
+  if(myrank==0){
+    node_list=malloc(sizeof(int)*3*np);
+  }
+  MPI_Gather(coords_fjmpi, 3, MPI_INT, node_list, 3, MPI_INT, 0, MPI_COMM_WORLD);
+  profile_add_bytes(sizeof(int)*3.0*((myrank==0) ? np+1 : 1));
+
+  int err=0;
+  int buf[9];
+  if(myrank==0){
+    rankmap_candidate best;
+    if(search_candidates(&best, dim, node_list, shape_fjmpi, mode) == 0){
+      fprintf(stderr, "no valid map for %dx%dx%dx%d processes on %dx%dx%d nodes\n",
+              dim->psize[0], dim->psize[1], dim->psize[2], dim->psize[3],
+              shape_fjmpi[0], shape_fjmpi[1], shape_fjmpi[2]);
+      err=1;
+    } else {
+      for(int i=0; i<4; i++){
+        buf[i]  =best.dim.intra_psize[i];
+        buf[4+i]=best.dirmap[i];
+      }
+      buf[8]=best.dim.notofu_dir;
+    }
+    free(node_list);
+  }
+  if(dim->fallback_time>0.0){
+    MPI_Bcast(&err, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    profile_add_bytes(sizeof(int));
+    if(err){ return 0; }
+  }
+  check_error(err, 0, "automatic search");
+
+  MPI_Bcast(buf, 9, MPI_INT, 0, MPI_COMM_WORLD);
+  profile_add_bytes(9*sizeof(int));
+  for(int i=0; i<4; i++){
+    dim->intra_psize[i]=buf[i];
+    dirmap[i]=buf[4+i];
+  }
+  dim->notofu_dir=buf[8];
+  dim->fold.type=FOLD_NONE;
+  if(myrank==0){
+    printf("selected: intra-node process lattice %dx%dx%dx%d, notofu direction %d\n",
+           dim->intra_psize[0], dim->intra_psize[1], dim->intra_psize[2], dim->intra_psize[3],
+           dim->notofu_dir+1);
+  }
+  return 1;
+}
+
+
+/********************************************************
+ * map by the fallback mapper (rankmap_fallback.h)
+ *   rank 0 collects the node coordinates of all the ranks
+ *   and makes the rank list
+ ********************************************************/
+void set_fallback_rankmap(int *rank_list, proc_dim *dim, const int *coords_map, const int *shape_map){
+  int *node_list=NULL;
+  if(myrank==0){
+    node_list=malloc(sizeof(int)*3*np);
+  }
+  MPI_Gather(coords_map, 3, MPI_INT, node_list, 3, MPI_INT, 0, MPI_COMM_WORLD);
+  profile_add_bytes(sizeof(int)*3.0*((myrank==0) ? np+1 : 1));
+
+  int rc=0;
+  if(myrank==0){
+    printf("no direction map for %dx%dx%dx%d processes on the nodes, using the fallback mapper (%g sec)\n",
+           dim->psize[0], dim->psize[1], dim->psize[2], dim->psize[3], dim->fallback_time);
+    fallback_stat stat;
+    rc=fallback_map(rank_list, &stat, node_list, shape_map, dim->periodic, dim, dim->fallback_time);
+    if(rc==0){
+      print_fallback_stat(stdout, &stat);
+    }
+    free(node_list);
+  }
+  check_error(rc, 0, "fallback_map");
+  dim->fallback=1;
+  dim->fold.type=FOLD_NONE;
+}
+
+
+/********************************************************
+ * node coordinate folded on XYZabc (--physical)
+ *   rank 0 gathers the 6-dim and the logical coordinates,
+ *   folds them, and scatters the folded coordinate
+ *   map: on rank 0, to convert the rank list to the logical one
+ ********************************************************/
+void fold_physical(int *coords_map, int *shape_map, tofu_map *map, const int *coords_fjmpi){
+  const int n=TOFU_DIM+3;
+  int send[TOFU_DIM+3];
+  int rc=topology_get_tofu_coords(myrank, send);
+  check_error(rc, TOPOLOGY_SUCCESS, "topology_get_tofu_coords");
+  for(int i=0; i<3; i++){
+    send[TOFU_DIM+i]=coords_fjmpi[i];
+  }
+  int *recv=NULL;
+  int *folded=NULL;
+  if(myrank==0){
+    recv=malloc(sizeof(int)*n*np);
+  }
+  MPI_Gather(send, n, MPI_INT, recv, n, MPI_INT, 0, MPI_COMM_WORLD);
+  profile_add_bytes(sizeof(int)*(double)n*((myrank==0) ? np+1 : 1));
+
+  int err=0;
+  if(myrank==0){
+    int *tofu_list=malloc(sizeof(int)*TOFU_DIM*np);
+    int *node_list=malloc(sizeof(int)*3*np);
+    folded=malloc(sizeof(int)*3*np);
+    for(int r=0; r<np; r++){
+      for(int i=0; i<TOFU_DIM; i++){
+        tofu_list[TOFU_DIM*r+i]=recv[n*r+i];
+      }
+      for(int i=0; i<3; i++){
+        node_list[3*r+i]=recv[n*r+TOFU_DIM+i];
+      }
+    }
+    free(recv);
+    err=tofu_fold(map, folded, tofu_list, node_list, np);
+    if(!err){
+      const int *t=map->tofu_shape;
+      printf("physical: XYZabc %dx%dx%dx%dx%dx%d, folded node shape %d %d %d\n",
+             t[0], t[1], t[2], t[3], t[4], t[5], map->shape[0], map->shape[1], map->shape[2]);
+      for(int i=0; i<3; i++){
+        shape_map[i]=map->shape[i];
+      }
+    }
+    free(tofu_list);
+    free(node_list);
+  }
+  check_error(err, 0, "tofu_fold");
+
+  MPI_Scatter(folded, 3, MPI_INT, coords_map, 3, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Bcast(shape_map, 3, MPI_INT, 0, MPI_COMM_WORLD);
+  profile_add_bytes(sizeof(int)*6.0);
+  free(folded);
+}
+
+
+/********************************************************
+ * actual work
+ *   obtain 3 dim MPI coodinate and map to 1 dim rank id
+ *   for a suitable 4 dim map
+ *   N.B. the map from 4dim to 1dim is defeind in calc_rankid()
+ *
+ *   with --physical, the map is built on the node lattice folded
+ *   from the 6-dim Tofu coordinate, and rank_list has the logical
+ *   coordinate of the same node; tofu_rank_list (on rank 0, if not NULL)
+ *   has the 6-dim coordinate of each rankid
+ ********************************************************/
+void set_rankmap(int *rank_list, int *tofu_rank_list, int *shape_fjmpi, proc_dim *dim, const int auto_mode){
+  // obatin the 3dim rank coordinate
+  profile_begin(PROF_TOPOLOGY);
+  int coords_fjmpi[4]={0,0,0,0};
+  get_node_coords(coords_fjmpi, shape_fjmpi);
+  profile_end(PROF_TOPOLOGY);
+  if(myrank==0){
+    printf("shape of %s: %d %d %d\n", topology_name, shape_fjmpi[0], shape_fjmpi[1], shape_fjmpi[2]);
+    printf("using rankmap: %s\n", rankmap_name);
+  }
+  profile_begin(PROF_CHECK);
+  int bad_rank=-1;
+  if(myrank==0){
+    bad_rank=check_rank_order(dim->psize);
+    if(bad_rank>=0){
+      printf("%s is not a bijection on the process lattice: rank %d\n", rankmap_name, bad_rank);
+    }
+  }
+  check_error(bad_rank, -1, "check_rank_order");
+  profile_end(PROF_CHECK);
+
+  profile_begin(PROF_TOPOLOGY);
+  int periodic[3];
+  int rc=topology_get_periodic(periodic);
+  check_error(rc, TOPOLOGY_SUCCESS, "topology_get_periodic");
+  profile_end(PROF_TOPOLOGY);
+  set_periodic(dim, periodic);
+
+  // the node coordinate for the map: logical, or folded on XYZabc
+  int coords_map[4];
+  int shape_map[3];
+  for(int i=0; i<4; i++){
+    coords_map[i]=coords_fjmpi[i];
+  }
+  for(int i=0; i<3; i++){
+    shape_map[i]=shape_fjmpi[i];
+  }
+  tofu_map tmap;
+  if(dim->physical){
+    profile_begin(PROF_TOPOLOGY);
+    fold_physical(coords_map, shape_map, &tmap, coords_fjmpi);
+    profile_end(PROF_TOPOLOGY);
+  }
+
+  profile_begin(PROF_MAP);
+  int dirmap[4];
+  int found=1;
+  if(auto_mode != AUTO_OFF){
+    found=search_map(dirmap, dim, coords_map, shape_map, auto_mode);
+  } else if(dim->fallback_time>0.0){
+    found=find_direction_map(dirmap, dim, shape_map);
+    if(found && myrank==0 && dim->fold.type != FOLD_NONE){
+      print_fold(stdout, dim);
+    }
+  } else {
+    set_direction_map(dirmap, dim, shape_map);
+  }
+  if(!found){
+    set_fallback_rankmap(rank_list, dim, coords_map, shape_map);
+    profile_end(PROF_MAP);
+    if(dim->physical && myrank==0){
+      tofu_unfold(&tmap, rank_list, tofu_rank_list, np);
+      free_tofu_map(&tmap);
+    }
+    return;
+  }
+  profile_end(PROF_MAP);
+
+  profile_begin(PROF_INTRA_RANK);
+  int intra_rank;
+  int node_np;
+  get_intra_rank(&intra_rank, &node_np, coords_map, shape_map);
+  check_error(node_np != dim->ppn, 0, "number of the processes in the node");
+  profile_end(PROF_INTRA_RANK);
+
+  int coords[4];
+  calc_proc_coords(coords, coords_map, intra_rank, dirmap, dim);
+
+  int rankid=calc_rankid(coords, dim->psize);
+
+  // every rankid and every (node, intra-node rank) exactly once
+  profile_begin(PROF_CHECK);
+  int nerr=check_bijection(rankid, node_index(coords_map, shape_map), intra_rank,
+                           shape_map[0]*shape_map[1]*shape_map[2], dim->ppn);
+  check_error(nerr, 0, "check_bijection");
+  profile_end(PROF_CHECK);
+
+#ifdef DEBUG
+  printf("I am %d: dirmap= %d %d %d %d\n", myrank, dirmap[0], dirmap[1], dirmap[2], dirmap[3]);
+  printf("I am %d: coords_fjmpi[i]         = %d %d %d %d\n", myrank, coords_fjmpi[0], coords_fjmpi[1], coords_fjmpi[2], coords_fjmpi[3]);
+  printf("I am %d: coords_map[dirmap[i]]   = %d %d %d %d\n", myrank, coords_map[dirmap[0]], coords_map[dirmap[1]], coords_map[dirmap[2]], coords_map[dirmap[3]]);
+  printf("I am %d: intra_rank=%d\n", myrank, intra_rank);
+  printf("I am %d: rankid=%d, coords=%d,%d,%d,%d\n", myrank, rankid, coords[0], coords[1], coords[2], coords[3]);
+  //  fflush(0);
+#endif
+
+  // collect (rankid, 3-dim coordinate) of all the processes on rank 0
+  collect_rank_list(rank_list, rankid, coords_map, shape_map);
+  if(dim->physical && myrank==0){
+    tofu_unfold(&tmap, rank_list, tofu_rank_list, np);
+    free_tofu_map(&tmap);
+  }
+
+  return;
+}
+
+
+/********************************************************
+ * rankmap of an ensemble (rankmap_4d_ensemble.c)
+ *   rank 0 collects the node coordinates of all the ranks,
+ *   packs the boxes of the members, and builds the rank list
+ ********************************************************/
+void set_ensemble_rankmap(int *rank_list, int *shape_fjmpi, int *periodic, ensemble *ens){
+  profile_begin(PROF_TOPOLOGY);
+  int coords_fjmpi[4];
+  get_node_coords(coords_fjmpi, shape_fjmpi);
+  int given[3];
+  int rc=topology_get_periodic(given);
+  check_error(rc, TOPOLOGY_SUCCESS, "topology_get_periodic");
+  for(int i=0; i<3; i++){
+    if(periodic[i]<0){
+      periodic[i]=given[i];
+    }
+  }
+  int *node_list=NULL;
+  if(myrank==0){
+    node_list=malloc(sizeof(int)*3*np);
+  }
+  MPI_Gather(coords_fjmpi, 3, MPI_INT, node_list, 3, MPI_INT, 0, MPI_COMM_WORLD);
+  profile_add_bytes(sizeof(int)*3.0*((myrank==0) ? np+1 : 1));
+  profile_end(PROF_TOPOLOGY);
+
+  profile_begin(PROF_MAP);
+  int bad_order=0;
+  if(myrank==0){
+    for(int k=0; k<ens->num && !bad_order; k++){
+      int bad_rank=check_rank_order(ens->member[k].dim.psize);
+      if(bad_rank>=0){
+        printf("%s is not a bijection on the process lattice of member %d: rank %d\n", rankmap_name, k, bad_rank);
+      }
+      bad_order = (bad_rank != -1);
+    }
+  }
+  check_error(bad_order, 0, "check_rank_order");
+  int bad=0;
+  int missing=0;
+  if(myrank==0){
+    bad=pack_ensemble(ens, shape_fjmpi, periodic);
+    if(bad){
+      const ensemble_member *m=&ens->member[bad-1];
+      printf("member %d (%d processes, intra-node %dx%dx%dx%d) does not fit in the free nodes of %dx%dx%d\n",
+             bad-1, m->np, m->dim.intra_psize[0], m->dim.intra_psize[1], m->dim.intra_psize[2],
+             m->dim.intra_psize[3], shape_fjmpi[0], shape_fjmpi[1], shape_fjmpi[2]);
+    } else {
+      print_ensemble(stdout, ens, shape_fjmpi);
+      missing=ensemble_rank_list(rank_list, ens, node_list, np, shape_fjmpi);
+      if(missing){
+        printf("%d ranks of the ensemble have no process in the allocation\n", missing);
+      }
+    }
+  }
+  free(node_list);
+  check_error(bad, 0, "pack_ensemble");
+  check_error(missing, 0, "ensemble_rank_list");
+  profile_end(PROF_MAP);
+}
+
+
+/********************************************************
+ * cache of the generated rankmap
+ *   only rank 0 touches the cache directory, and
+ *   broadcasts whether the rankmap file is taken from it
+ *   key: set on rank 0, to store the map after a miss
+ *   lookup=0: only the key (the analysis needs the generated map)
+ *   returns 1 on all the ranks for a hit
+ ********************************************************/
+int lookup_rankmap_cache(char *key, const char *dir, const proc_dim *dim, const int auto_mode,
+                         const int lookup){
+  int hit=0;
+  key[0]='\0';
+  if(myrank==0){
+    int shape_fjmpi[3];
+    int periodic[3];
+    if(topology_get_shape(shape_fjmpi) == TOPOLOGY_SUCCESS
+       && topology_get_periodic(periodic) == TOPOLOGY_SUCCESS){
+      rankmap_cache_key(key, dim, shape_fjmpi, periodic, auto_mode);
+      if(lookup){
+        hit=rankmap_cache_lookup(dir, key, auto_mode != AUTO_OFF);
+      }
+    }
+  }
+  MPI_Bcast(&hit, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  profile_add_bytes(sizeof(int));
+  return hit;
+}
+
+
+/********************************************************
+ * profile report (--profile)
+ *   min/max/avg over the ranks, written by rank 0
+ ********************************************************/
+void write_profile_report(const char *program, const proc_dim *dim){
+  const int n=2*PROF_NPHASE+2;
+  double local[2*PROF_NPHASE+2];
+  double vmin[2*PROF_NPHASE+2];
+  double vmax[2*PROF_NPHASE+2];
+  double vsum[2*PROF_NPHASE+2];
+  profile_report r;
+  profile_local_report(&r);
+  for(int k=0; k<PROF_NPHASE; k++){
+    local[k]=r.time[k].sum;
+    local[PROF_NPHASE+k]=r.bytes[k].sum;
+  }
+  local[2*PROF_NPHASE]=r.total_time.sum;
+  local[2*PROF_NPHASE+1]=r.peak_rss_kb.sum;
+  MPI_Reduce(local, vmin, n, MPI_DOUBLE, MPI_MIN, 0, MPI_COMM_WORLD);
+  MPI_Reduce(local, vmax, n, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+  MPI_Reduce(local, vsum, n, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  if(myrank != 0){
+    return;
+  }
+
+  profile_stat *stat[2*PROF_NPHASE+2];
+  for(int k=0; k<PROF_NPHASE; k++){
+    stat[k]=&r.time[k];
+    stat[PROF_NPHASE+k]=&r.bytes[k];
+  }
+  stat[2*PROF_NPHASE]=&r.total_time;
+  stat[2*PROF_NPHASE+1]=&r.peak_rss_kb;
+  for(int i=0; i<n; i++){
+    stat[i]->min=vmin[i];
+    stat[i]->max=vmax[i];
+    stat[i]->sum=vsum[i];
+    stat[i]->avg=vsum[i]/np;
+  }
+  r.program=program;
+  r.rankmap=rankmap_name;
+  r.np=np;
+  r.ppn=dim->ppn;
+  for(int i=0; i<4; i++){
+    r.psize[i]=dim->psize[i];
+  }
+  if(topology_get_shape(r.shape) != TOPOLOGY_SUCCESS){
+    r.shape[0]=r.shape[1]=r.shape[2]=0;
+  }
+
+  FILE *fp=fopen(RANK_MAP_PROFILE_FILE, "w");
+  if(!fp){
+    fprintf(stderr, "cannot open the output file: %s\n", RANK_MAP_PROFILE_FILE);
+    return;
+  }
+  profile_write_json(fp, &r);
+  fclose(fp);
+  printf("profile report: %s\n", RANK_MAP_PROFILE_FILE);
+}
@@ -0,0 +1,371 @@
+/*
+  4-dim rankmap generator for Fugaku: offline (serial) version
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+                 generates the same file as rankmap_4d_general
+                 without launching MPI
+    2026 Oct. 17 the rankid order at run time (--order=)
+    2026 Oct. 17 cache of the generated rankmap (--cache=)
+    2026 Oct. 17 time and memory of each phase (--profile)
+    2026 Oct. 17 the map on the 6-dim Tofu coordinate (--physical)
+    2026 Oct. 17 CPU and memory binding on the CMGs (--bind)
+    2026 Oct. 17 fallback mapper if the process lattice does not match the nodes
+    2026 Oct. 17 rankmap files for other launchers (--format=), topology description file (--topology=)
+    2026 Oct. 17 the steps after the generation in rankmap_4d_post.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "config.h"
+#include "rankmap_4d_core.h"
+#include "topology.h"
+#include "rankmap_option.h"
+#include "rankmap_analyze.h"
+#include "rankmap_auto.h"
+#include "rankmap_cache.h"
+#include "rankmap_profile.h"
+#include "rankmap_tofu.h"
+#include "rankmap_4d_post.h"
+#include "rankmap_fallback.h"
+#include "rankmap_topofile.h"
+
+// global
+int np;
+int myrank=0;
+
+
+void show_usage(char const * const *argv){
+    printf("usage: %s P1 P2 P3 P4 p1 p2 p3 p4 PP1 PP2 PP3 [node_order] [--ppn=N] [--order=NAME] [--cache=DIR] [--mesh=AXES] [--lattice=LxLxLxL] [--analyze] [--congestion] [--table] [--profile] [--physical] [--bind] [--fallback-time=SEC] [--format=NAME]\n", argv[0]);
+    printf("       %s P1 P2 P3 P4 PP1 PP2 PP3 [node_order] --auto [--ppn=N] [--order=NAME] [--cache=DIR] [--mesh=AXES] [--lattice=LxLxLxL] [--analyze] [--congestion] [--table] [--profile] [--physical] [--bind] [--fallback-time=SEC] [--format=NAME]\n", argv[0]);
+    printf("       %s P1 P2 P3 P4 p1 p2 p3 p4 --topology=FILE [options]\n", argv[0]);
+    printf("       %s P1 P2 P3 P4 --topology=FILE --auto [options]\n", argv[0]);
+    printf("       P1,P2,P3,P4: total process lattice\n");
+    printf("       p1,p2,p3,p4: intra-node process lattice (p1 x p2 x p3 x p4 = ppn)\n");
+    printf("       PP1,PP2,PP3: node shape (as in #PJM --rsc-list \"node=PP1xPP2xPP3\")\n");
+    printf("       node_order:  order of the nodes in the MPI rank (default: xyz = x runs fastest)\n");
+    printf("       --ppn=N:   number of the processes in a node (default: 4)\n");
+    printf("       --auto:    search the intra-node process lattice and the direction map\n");
+    printf("       --cache=DIR: take the rankmap from the cache directory, or store it\n");
+    printf("       --mesh=AXES: non-periodic node axes, e.g. --mesh=xz (default: RANKMAP_SIM_MESH)\n");
+    printf("       --order=NAME: rankid order: lex, reversed, blocked:B1xB2xB3xB4, morton or hilbert\n");
+    printf("       --lattice=LxLxLxL: global lattice size, to minimize the off-node halo bytes\n");
+    printf("       --site-bytes=N: bytes of a site on the halo surface (default: 96)\n");
+    printf("       --analyze: print the hop distance of the halo exchange\n");
+    printf("       --congestion: print the link load of the halo exchange\n");
+    printf("       --table:   write the binary neighbor table (%s)\n", RANK_MAP_TABLE_FILE);
+    printf("       --profile: write the time and memory of each phase (%s)\n", RANK_MAP_PROFILE_FILE);
+    printf("       --physical: map on the 6-dim Tofu coordinate XYZabc (RANKMAP_SIM_TOFU_OFFSET)\n");
+    printf("       --bind:    write the CPU and memory binding of each rankid on the CMGs (%s)\n", RANK_MAP_BIND_FILE);
+    printf("       --fallback-time=SEC: time budget of the fallback mapper, if the process lattice does not match the nodes (default: 10, 0: abort)\n");
+    printf("       --format=NAME: also write the rankmap for another launcher: rankfile (Open MPI), slurm or mpich\n");
+    printf("       --topology=FILE: topology description file: the nodes instead of PP1 PP2 PP3, and the host names of --format\n");
+    printf("  ex. %s 8 4 4 4 1 2 2 1 8 4 4--> 8x4x4x4 process lattice, 1x2x2x1 intra-node process lattice on 8x4x4 nodes (merge fold)\n", argv[0]);
+}
+
+/**************************************************
+
+  utility functions (serial version)
+
+**************************************************/
+void safe_abort_(int status, const char* file, int line){
+  printf("safe_abort is called in %s, at line %d:  status=%d\n", file, line, status);
+  fflush(stdout);
+  exit(status);
+}
+
+void check_error(const int rc, const int success, const char* msg){
+  if(rc != success){
+    fprintf(stderr, "error at %s\n", msg);
+    safe_abort(EXIT_FAILURE);
+  }
+}
+
+
+/********************************************************
+ * actual work
+ *   same as set_rankmap() in rankmap_4d_mpi.c,
+ *   but loops over all the MPI ranks
+ ********************************************************/
+void set_rankmap_offline(int *rank_list, int *tofu_rank_list, const int *shape_fjmpi, proc_dim *dim,
+                         const int auto_mode){
+  int rc;
+  printf("shape of %s: %d %d %d\n", topology_name, shape_fjmpi[0], shape_fjmpi[1], shape_fjmpi[2]);
+  printf("using rankmap: %s\n", rankmap_name);
+  profile_begin(PROF_CHECK);
+  int bad_rank=check_rank_order(dim->psize);
+  if(bad_rank>=0){
+    printf("%s is not a bijection on the process lattice: rank %d\n", rankmap_name, bad_rank);
+  }
+  check_error(bad_rank, -1, "check_rank_order");
+  profile_end(PROF_CHECK);
+
+  profile_begin(PROF_TOPOLOGY);
+  int periodic[3];
+  rc = topology_get_periodic(periodic);
+  check_error(rc, TOPOLOGY_SUCCESS, "topology_get_periodic");
+  set_periodic(dim, periodic);
+  // with the fallback mapper, the processes can be on the first nodes of the shape
+  const int full_np=dim->ppn*shape_fjmpi[0]*shape_fjmpi[1]*shape_fjmpi[2];
+  if(np > full_np || (np < full_np && dim->fallback_time<=0.0)){
+    fprintf(stderr, "np=%d != ppn x PP1 x PP2 x PP3 (ppn=%d)\n", np, dim->ppn);
+    safe_abort(EXIT_FAILURE);
+  }
+
+  // 3-dim node coordinate of all the MPI ranks
+  int *node_list=malloc(sizeof(int)*3*np);
+  for(int rank=0; rank<np; rank++){
+    rc = topology_get_coords(rank, 3, node_list+3*rank);
+    check_error(rc, TOPOLOGY_SUCCESS, "topology_get_coords");
+  }
+
+  // the node coordinate for the map: logical, or folded on XYZabc
+  int shape_map[3];
+  for(int i=0; i<3; i++){
+    shape_map[i]=shape_fjmpi[i];
+  }
+  tofu_map tmap;
+  if(dim->physical){
+    int *tofu_list=malloc(sizeof(int)*TOFU_DIM*np);
+    int *folded=malloc(sizeof(int)*3*np);
+    for(int rank=0; rank<np; rank++){
+      rc = topology_get_tofu_coords(rank, tofu_list+TOFU_DIM*rank);
+      check_error(rc, TOPOLOGY_SUCCESS, "topology_get_tofu_coords");
+    }
+    rc = tofu_fold(&tmap, folded, tofu_list, node_list, np);
+    check_error(rc, 0, "tofu_fold");
+    const int *t=tmap.tofu_shape;
+    printf("physical: XYZabc %dx%dx%dx%dx%dx%d, folded node shape %d %d %d\n",
+           t[0], t[1], t[2], t[3], t[4], t[5], tmap.shape[0], tmap.shape[1], tmap.shape[2]);
+    for(int i=0; i<3; i++){
+      shape_map[i]=tmap.shape[i];
+    }
+    free(tofu_list);
+    free(node_list);
+    node_list=folded;
+  }
+  profile_end(PROF_TOPOLOGY);
+
+  profile_begin(PROF_MAP);
+  int dirmap[4];
+  int found=1;
+  if(auto_mode != AUTO_OFF){
+    rankmap_candidate best;
+    if(search_candidates(&best, dim, node_list, shape_map, auto_mode) == 0){
+      fprintf(stderr, "no valid map for %dx%dx%dx%d processes on %dx%dx%d nodes\n",
+              dim->psize[0], dim->psize[1], dim->psize[2], dim->psize[3],
+              shape_fjmpi[0], shape_fjmpi[1], shape_fjmpi[2]);
+      if(dim->fallback_time<=0.0){
+        safe_abort(EXIT_FAILURE);
+      }
+      found=0;
+    } else {
+      *dim=best.dim;
+      for(int i=0; i<4; i++){
+        dirmap[i]=best.dirmap[i];
+      }
+      printf("selected: intra-node process lattice %dx%dx%dx%d, notofu direction %d\n",
+             dim->intra_psize[0], dim->intra_psize[1], dim->intra_psize[2], dim->intra_psize[3],
+             dim->notofu_dir+1);
+    }
+  } else if(dim->fallback_time>0.0){
+    found=(np==full_np) && find_direction_map(dirmap, dim, shape_map);
+    if(found && dim->fold.type != FOLD_NONE){
+      print_fold(stdout, dim);
+    }
+  } else {
+    set_direction_map(dirmap, dim, shape_map);
+  }
+
+  if(found){
+    build_rank_list(rank_list, node_list, shape_map, dirmap, dim);
+  } else {
+    printf("no direction map for %dx%dx%dx%d processes on the nodes, using the fallback mapper (%g sec)\n",
+           dim->psize[0], dim->psize[1], dim->psize[2], dim->psize[3], dim->fallback_time);
+    fallback_stat stat;
+    rc=fallback_map(rank_list, &stat, node_list, shape_map, dim->periodic, dim, dim->fallback_time);
+    check_error(rc, 0, "fallback_map");
+    print_fallback_stat(stdout, &stat);
+    dim->fallback=1;
+    dim->fold.type=FOLD_NONE;
+  }
+  free(node_list);
+  profile_end(PROF_MAP);
+
+  // sanity check
+  profile_begin(PROF_CHECK);
+  int i=check_rank_list(rank_list, shape_map);
+  if(i>=0){
+    fprintf(stderr, "cannot happen: i=%d, rank_list[3*i]=%d,%d,%d\n", i, rank_list[3*i], rank_list[3*i+1], rank_list[3*i+2]);
+    safe_abort(EXIT_FAILURE);
+  }
+  if(dim->physical){
+    tofu_unfold(&tmap, rank_list, tofu_rank_list, np);
+    free_tofu_map(&tmap);
+  }
+  profile_end(PROF_CHECK);
+}
+
+
+/********************************************************
+ * key of the cache, and the lookup (--cache=)
+ *   same as lookup_rankmap_cache() in rankmap_4d_mpi.c
+ ********************************************************/
+int lookup_rankmap_cache(char *key, const char *dir, const proc_dim *dim, const int auto_mode,
+                         const int lookup){
+  int shape_fjmpi[3];
+  int periodic[3];
+  int rc = topology_get_shape(shape_fjmpi);
+  check_error(rc, TOPOLOGY_SUCCESS, "topology_get_shape");
+  rc = topology_get_periodic(periodic);
+  check_error(rc, TOPOLOGY_SUCCESS, "topology_get_periodic");
+  rankmap_cache_key(key, dim, shape_fjmpi, periodic, auto_mode);
+  return lookup && rankmap_cache_lookup(dir, key, auto_mode != AUTO_OFF);
+}
+
+
+/********************************************************
+ * profile report (--profile) of this process
+ *   same as write_profile_report() in rankmap_4d_mpi.c
+ ********************************************************/
+void write_profile_report(const char *program, const proc_dim *dim){
+  profile_report r;
+  profile_local_report(&r);
+  r.program=program;
+  r.rankmap=rankmap_name;
+  r.np=np;
+  r.ppn=dim->ppn;
+  for(int i=0; i<4; i++){
+    r.psize[i]=dim->psize[i];
+  }
+  if(topology_get_shape(r.shape) != TOPOLOGY_SUCCESS){
+    r.shape[0]=r.shape[1]=r.shape[2]=0;
+  }
+  FILE *fp=fopen(RANK_MAP_PROFILE_FILE, "w");
+  if(!fp){
+    fprintf(stderr, "cannot open the output file: %s\n", RANK_MAP_PROFILE_FILE);
+    return;
+  }
+  profile_write_json(fp, &r);
+  fclose(fp);
+  printf("profile report: %s\n", RANK_MAP_PROFILE_FILE);
+}
+
+
+int main(int argc, char** argv){
+
+  // read options
+  rankmap_option opt;
+  int bad=get_option(&opt, &argc, argv);
+  if(bad){
+    printf("unknown or bad option: %s\n", argv[bad]);
+    show_usage((char const * const *)argv);
+    exit(EXIT_FAILURE);
+  }
+
+  // rankid order
+  if(opt.order && select_rankmap_order(opt.order)){
+    printf("unknown rankid order: %s\n", opt.order);
+    show_usage((char const * const *)argv);
+    exit(EXIT_FAILURE);
+  }
+
+  // host-based rankmap file
+  int format = opt.format ? hostmap_format(opt.format) : HOSTMAP_VCOORD;
+  if(format<0){
+    printf("unknown rankmap format: %s\n", opt.format);
+    show_usage((char const * const *)argv);
+    exit(EXIT_FAILURE);
+  }
+
+  // read parameters
+  //   the intra-node process lattice is not given with --auto,
+  //   and the node shape is not given with --topology
+  int shape_arg = opt.auto_search ? 5 : 9;
+  if(argc<shape_arg+(opt.topology ? 0 : 3)){
+    show_usage((char const * const *)argv);
+    exit(EXIT_FAILURE);
+  }
+  topofile topo;
+  if(opt.topology){
+    check_error(read_topofile(&topo, opt.topology), 0, "read_topofile");
+  }
+  np=atoi(argv[1])*atoi(argv[2])*atoi(argv[3])*atoi(argv[4]);
+  proc_dim proc;
+  int ppn = (opt.ppn>0) ? opt.ppn : (opt.topology ? topo.ppn : 4);
+  get_param(&proc, opt.auto_search ? 5 : argc, (char const * const *)argv, ppn);
+  for(int i=0; i<3; i++){
+    proc.periodic[i] = (opt.topology && opt.periodic[i]<0) ? topo.periodic[i] : opt.periodic[i];
+  }
+  proc.physical=opt.physical;
+  proc.fallback_time=opt.fallback_time;
+  set_lattice(&proc, opt.lattice, opt.site_bytes);
+
+  int shape_fjmpi[3];
+  const char *order=NULL;
+  if(opt.topology){
+    for(int i=0; i<3; i++){
+      shape_fjmpi[i]=topo.shape[i];
+    }
+  } else {
+    shape_fjmpi[0]=atoi(argv[shape_arg]);
+    shape_fjmpi[1]=atoi(argv[shape_arg+1]);
+    shape_fjmpi[2]=atoi(argv[shape_arg+2]);
+    if(argc>shape_arg+3){
+      order=argv[shape_arg+3];
+    }
+  }
+  int rc = topology_sim_config(shape_fjmpi, ppn, order, NULL);
+  check_error(rc, TOPOLOGY_SUCCESS, "topology_sim_config");
+  if(opt.topology){
+    // the nodes of the file in the MPI rank order
+    rc = topology_sim_nodes(topo.coords, topo.num_nodes);
+    check_error(rc, TOPOLOGY_SUCCESS, "topology_sim_nodes");
+    free_topofile(&topo);
+  }
+
+  // the same map in the cache (rankmap_4d_post.c)
+  int auto_mode = opt.auto_search ? AUTO_ANY_SPLIT : AUTO_OFF;
+  char cache_key[RANKMAP_CACHE_KEY_MAX];
+  if(rankmap_cached(cache_key, argv[0], &opt, &proc, auto_mode)){
+    printf("finished: rankmap_4d_offline (cached).\n");
+    return 0;
+  }
+
+  clock_t t0=clock();
+
+  // allocate rankmap list
+  int *rank_list=malloc(sizeof(int)*3*np);
+  int *tofu_rank_list = proc.physical ? malloc(sizeof(int)*TOFU_DIM*np) : NULL;
+
+  // generate rankmap
+  set_rankmap_offline(rank_list, tofu_rank_list, shape_fjmpi, &proc, auto_mode);
+
+  // analysis, output files, cache and profile report (rankmap_4d_post.c)
+  rankmap_postprocess(argv[0], &opt, &proc, rank_list, tofu_rank_list, shape_fjmpi,
+                      cache_key, auto_mode);
+
+  // reallocate
+  free(rank_list);
+  free(tofu_rank_list);
+
+  clock_t t1=clock();
+  printf("finished: rankmap_4d_offline. (%.3f sec)\n", (double)(t1-t0)/CLOCKS_PER_SEC);
+  return 0;
+}
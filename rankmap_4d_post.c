@@ -0,0 +1,187 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version: CPU and memory binding (--bind),
+                 split from the main of rankmap_4d.c, rankmap_4d_general.c
+                 and rankmap_4d_offline.c
+    2026 Oct. 17 host-based rankmap file (--format=)
+    2026 Oct. 17 binary neighbor table (--table)
+    2026 Oct. 17 cache of the generated rankmap (--cache=)
+    2026 Oct. 17 link load of the halo exchange (--congestion), output of the rankmap
+    2026 Oct. 17 hop distance and off-node bytes of the halo exchange (--analyze, --lattice=)
+    2026 Oct. 17 time and memory of each phase (--profile)
+ */
+#include <stdio.h>
+#include "config.h"
+#include "rankmap_profile.h"
+#include "rankmap_analyze.h"
+#include "rankmap_congestion.h"
+#include "rankmap_tofu.h"
+#include "rankmap_cmg.h"
+#include "rankmap_auto.h"
+#include "rankmap_cache.h"
+#include "rankmap_topofile.h"
+#include "rankmap_4d_post.h"
+
+
+// hop distance (--analyze) and off-node bytes (--lattice=) of the halo exchange
+static void post_analyze(const int *rank_list, const int *tofu_rank_list, const proc_dim *dim,
+                         const int *shape_fjmpi, const int analyze){
+  profile_begin(PROF_ANALYSIS);
+  if(myrank==0){
+    halo_stat stat;
+    analyze_halo(&stat, rank_list, dim->psize, shape_fjmpi, dim->periodic);
+    if(analyze){
+      print_halo_stat(stdout, &stat);
+      if(dim->physical){
+        print_tofu_halo(stdout, tofu_rank_list, dim);
+      }
+    }
+    if(dim->lattice[0]>0){
+      print_placement(stdout, dim);
+      print_halo_bytes(stdout, &stat, dim->lattice, dim->site_bytes);
+    }
+    free_halo_stat(&stat);
+  }
+  profile_end(PROF_ANALYSIS);
+}
+
+
+// link load of the halo exchange (--congestion)
+static void post_congestion(const int *rank_list, const proc_dim *dim, const int *shape_fjmpi){
+  profile_begin(PROF_ANALYSIS);
+  if(myrank==0){
+    double msg_bytes[HALO_NDIR];
+    const char *unit=halo_message_bytes(msg_bytes, dim->psize, dim->lattice, dim->site_bytes);
+    link_load ll;
+    simulate_links(&ll, rank_list, dim->psize, shape_fjmpi, dim->periodic, msg_bytes);
+    print_link_load(stdout, &ll, unit);
+    free_link_load(&ll);
+  }
+  profile_end(PROF_ANALYSIS);
+}
+
+
+// host-based rankmap file for other launchers (--format=)
+static void post_hostmap(const int *rank_list, const int format, const char *topology){
+  profile_begin(PROF_OUTPUT);
+  int rc=0;
+  if(myrank==0){
+    rc=output_hostmap(rank_list, np, format, topology);
+  }
+  check_error(rc, 0, "--format: writing the host-based rankmap file");
+  profile_end(PROF_OUTPUT);
+}
+
+
+// CPU and memory binding of each rankid (--bind)
+static void post_bind(const proc_dim *dim){
+  profile_begin(PROF_OUTPUT);
+  int rc=0;
+  if(myrank==0){
+    cmg_map cmap;
+    rc=set_cmg_map(&cmap, dim);
+    if(rc==0){
+      print_cmg_map(stdout, &cmap, dim);
+      printf("binding file: %s\n", RANK_MAP_BIND_FILE);
+      rc=write_binding(RANK_MAP_BIND_FILE, &cmap, dim);
+    }
+    free_cmg_map(&cmap);
+  }
+  check_error(rc, 0, "--bind: the processes per node do not fit the CMGs (or the fallback map), or cannot write the binding file");
+  profile_end(PROF_OUTPUT);
+}
+
+
+// binary neighbor table (--table)
+static void post_table(const int *rank_list, const proc_dim *dim, const int *shape_fjmpi){
+  profile_begin(PROF_TABLE);
+  int rc=0;
+  if(myrank==0){
+    printf("neighbor table: %s\n", RANK_MAP_TABLE_FILE);
+    rc=write_neighbor_table(RANK_MAP_TABLE_FILE, rank_list, dim->psize, shape_fjmpi, dim->periodic);
+  }
+  check_error(rc, 0, "writing the neighbor table");
+  profile_end(PROF_TABLE);
+}
+
+
+/********************************************************
+ * the same map in the cache (--cache=)
+ *   the analysis and the files other than the rankmap need
+ *   the generated map: the key is set, but not looked up
+ ********************************************************/
+int rankmap_cached(char *cache_key, const char *program, const rankmap_option *opt,
+                   const proc_dim *dim, const int auto_mode){
+  cache_key[0]='\0';
+  if(!opt->cache_dir || opt->physical){  // the physical map depends on the allocation
+    return 0;
+  }
+  profile_begin(PROF_CACHE);
+  const int lookup = !(opt->analyze || opt->congestion || opt->table || opt->bind || opt->format);
+  int hit=lookup_rankmap_cache(cache_key, opt->cache_dir, dim, auto_mode, lookup);
+  profile_end(PROF_CACHE);
+  if(hit && opt->profile){
+    write_profile_report(program, dim);
+  }
+  return hit;
+}
+
+
+/********************************************************
+ * after the rankmap is generated
+ ********************************************************/
+void rankmap_postprocess(const char *program, const rankmap_option *opt, const proc_dim *dim,
+                         const int *rank_list, const int *tofu_rank_list, const int *shape_fjmpi,
+                         const char *cache_key, const int auto_mode){
+  if(opt->analyze || dim->lattice[0]>0){
+    post_analyze(rank_list, tofu_rank_list, dim, shape_fjmpi, opt->analyze);
+  }
+  if(opt->congestion){
+    post_congestion(rank_list, dim, shape_fjmpi);
+  }
+
+  // output the rankmap to file
+  profile_begin(PROF_OUTPUT);
+  output_rankmap(rank_list);
+  profile_end(PROF_OUTPUT);
+
+  const int format = opt->format ? hostmap_format(opt->format) : HOSTMAP_VCOORD;
+  if(format != HOSTMAP_VCOORD){
+    post_hostmap(rank_list, format, opt->topology);
+  }
+  if(opt->bind){
+    post_bind(dim);
+  }
+  if(opt->table){
+    post_table(rank_list, dim, shape_fjmpi);
+  }
+
+  // store the map in the cache, unless it depends on the fallback mapper
+  if(opt->cache_dir && myrank==0 && cache_key[0] && !dim->fallback){
+    profile_begin(PROF_CACHE);
+    rankmap_cache_store(opt->cache_dir, cache_key, auto_mode != AUTO_OFF);
+    profile_end(PROF_CACHE);
+  }
+
+  // time and memory of each phase
+  if(opt->profile){
+    write_profile_report(program, dim);
+  }
+}
@@ -0,0 +1,57 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version: CPU and memory binding (--bind),
+                 split from the main of rankmap_4d.c, rankmap_4d_general.c
+                 and rankmap_4d_offline.c
+    2026 Oct. 17 cache of the generated rankmap (--cache=)
+    2026 Oct. 17 time and memory of each phase (--profile)
+ */
+#ifndef rankmap_4d_post_h
+#define rankmap_4d_post_h
+
+#include "rankmap_option.h"
+#include "rankmap_4d_core.h"
+
+/**************************************************
+
+  the same map in the cache (--cache=): 1 if found
+    cache_key: RANKMAP_CACHE_KEY_MAX bytes, for rankmap_postprocess()
+    program:   name of the program in the profile report (--profile),
+               written if found
+
+**************************************************/
+int rankmap_cached(char *cache_key, const char *program, const rankmap_option *opt,
+                   const proc_dim *dim, const int auto_mode);
+
+/**************************************************
+
+  the steps after the rankmap is generated, common to the generators
+    program:        name of the program in the profile report (--profile)
+    rank_list:      3-dim node coordinate of each rankid (rank 0 only)
+    tofu_rank_list: 6-dim Tofu coordinate of each rankid (--physical)
+    shape_fjmpi:    node shape
+    cache_key:      set by rankmap_cached(), the map is stored if given
+
+**************************************************/
+void rankmap_postprocess(const char *program, const rankmap_option *opt, const proc_dim *dim,
+                         const int *rank_list, const int *tofu_rank_list, const int *shape_fjmpi,
+                         const char *cache_key, const int auto_mode);
+
+#endif
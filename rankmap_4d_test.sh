@@ -0,0 +1,109 @@
+#!/bin/sh
+# Copyright (c) 2020-2023 Issaku Kanamori <kanamori-i@riken.jp>
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation; either version 3
+# of the License, or any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program. If not, see http://www.gnu.org/licenses/.
+#
+# See the full license in the file "LICENSE".
+#
+#   2026 Oct. 17 the first version
+#
+# regression test of the generators (make check)
+#
+#   usage: ./rankmap_4d_test.sh
+#
+# For each case below and for both the lex and the reversed order,
+# the MPI generator (rankmap_4d_general_* or rankmap_4d_*) runs on the
+# simulated topology, and rankmap_4d_offline_* runs with the same
+# parameters; the two rankmap_4d_list.txt must be the same byte for byte.
+# The MPI generators must be built with TOPOLOGY=sim.
+# The exit status is the number of the failed runs (0: all passed).
+#
+# environment:
+#   MPIRUN   MPI launcher, called as "$MPIRUN -np N prog ..." (default: mpirun)
+
+MPIRUN=${MPIRUN:-mpirun}
+SRCDIR=$(cd "$(dirname "$0")" && pwd)
+
+# generator P1 P2 P3 P4 p1 p2 p3 p4 PP1 PP2 PP3 mesh ('-': periodic)
+#   rankmap_4d takes the intra-node direction, the one with p > 1
+cases(){
+  cat <<EOF
+general  4 3 4 2  1 1 2 2  4 3 2  -
+general  4 3 4 2  2 1 1 2  4 3 2  -
+general  2 3 4 4  1 1 1 4  2 3 4  -
+# merge fold: the 2nd and the 3rd directions on y
+general  8 2 2 4  1 1 1 4  8 4 1  -
+# split fold: the 2nd direction on y and z
+general  4 6 1 4  1 1 1 4  4 3 2  -
+# ring embedding on the mesh axis
+general  4 3 4 2  1 1 2 2  4 3 2  z
+4d       4 3 2 4  1 1 1 4  4 3 2  -
+4d       8 3 4 2  1 1 4 1  8 3 2  x
+EOF
+}
+
+WORK=$(mktemp -d "${TMPDIR:-/tmp}/rankmap_4d_test.XXXXXX") || exit 1
+trap 'rm -rf "$WORK"' EXIT
+cd "$WORK" || exit 1
+
+failed=0
+passed=0
+while read -r gen P1 P2 P3 P4 p1 p2 p3 p4 PP1 PP2 PP3 mesh; do
+  [ -z "$mesh" ] && continue
+  np=$((P1*P2*P3*P4))
+  opt=""
+  [ "$mesh" != "-" ] && opt="--mesh=$mesh"
+  for order in lex reversed; do
+    if [ "$gen" = general ]; then
+      prog=rankmap_4d_general_$order
+      args="$P1 $P2 $P3 $P4 $p1 $p2 $p3 $p4"
+    else
+      prog=rankmap_4d_lex
+      [ "$order" = reversed ] && prog=rankmap_4d_lex_reversed
+      dir=1
+      [ "$p2" -gt 1 ] && dir=2
+      [ "$p3" -gt 1 ] && dir=3
+      [ "$p4" -gt 1 ] && dir=4
+      args="$P1 $P2 $P3 $P4 $dir"
+    fi
+    name="$prog $args${opt:+ $opt} on ${PP1}x${PP2}x${PP3}"
+
+    rm -f rankmap_4d_list.txt
+    RANKMAP_SIM_SHAPE=${PP1}x${PP2}x${PP3} $MPIRUN -np $np "$SRCDIR/$prog" $args $opt \
+        < /dev/null > mpi.log 2>&1 && mv rankmap_4d_list.txt mpi.txt
+    rc_mpi=$?
+    "$SRCDIR/rankmap_4d_offline_$order" $P1 $P2 $P3 $P4 $p1 $p2 $p3 $p4 $PP1 $PP2 $PP3 $opt \
+        < /dev/null > offline.log 2>&1 && mv rankmap_4d_list.txt offline.txt
+    rc_offline=$?
+
+    if [ $rc_mpi -ne 0 ] || [ $rc_offline -ne 0 ]; then
+      echo "FAIL: $name (exit status: mpi $rc_mpi, offline $rc_offline)"
+      tail -5 mpi.log offline.log
+      failed=$((failed+1))
+    elif ! cmp -s mpi.txt offline.txt; then
+      echo "FAIL: $name (rankmap_4d_list.txt differs from rankmap_4d_offline_$order)"
+      cmp mpi.txt offline.txt
+      failed=$((failed+1))
+    else
+      echo "ok:   $name"
+      passed=$((passed+1))
+    fi
+    rm -f mpi.txt offline.txt
+  done
+done <<EOF
+$(cases | grep -v '^#')
+EOF
+
+echo "rankmap_4d_test: $passed passed, $failed failed"
+exit $failed
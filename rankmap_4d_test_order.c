@@ -0,0 +1,198 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// defined in calc_rankid_order.c
+int calc_rankid(const int *coords, const int *psize);
+void get_rank_coord(int *coords, int rank, const int *psize);
+extern const char* rankmap_name;
+int select_rankmap_order(const char *name);
+int check_rankmap_order(const int *psize);
+const char *rankmap_order_name(const int k);
+
+/**************************************************
+
+  round trip test of the rankid orders (make check)
+    for every order in calc_rankid_order.c and every process
+    lattice below,
+      get_rank_coord(calc_rankid(c)) == c for all c,
+      calc_rankid() is onto 0, ..., np-1,
+      consecutive rankids are 1 hop apart (Hilbert on a 2^k cube)
+    blocked runs with 1x1x1x1 blocks, the smallest divisor of
+    each direction, and a single block; the block sizes which do
+    not divide the process lattice must be rejected
+  the exit status is the number of the failed cases
+
+**************************************************/
+#define SWEEP_MAX 8   // all the lattices of 1..SWEEP_MAX in each direction
+static const int extra_lattice[][4]={
+  {2,2,2,2}, {4,4,4,4}, {8,8,8,8},
+  {7,6,5,8}, {12,3,1,9}, {16,1,1,2}, {6,10,4,3}, {1,13,1,1}
+};
+
+static int power_of_2_cube(const int *psize){
+  for(int i=0; i<4; i++){
+    if(psize[i] != psize[0] || (psize[i] & (psize[i]-1))){
+      return 0;
+    }
+  }
+  return 1;
+}
+
+// returns 0 if the current order passes on the lattice
+static int check_lattice(const int *psize, const int unit_step){
+  const int np=psize[0]*psize[1]*psize[2]*psize[3];
+  char *hit=calloc(np, 1);
+  int err=0;
+  int c[4], back[4];
+  for(c[3]=0; c[3]<psize[3] && !err; c[3]++){
+  for(c[2]=0; c[2]<psize[2] && !err; c[2]++){
+  for(c[1]=0; c[1]<psize[1] && !err; c[1]++){
+  for(c[0]=0; c[0]<psize[0] && !err; c[0]++){
+    const int rank=calc_rankid(c, psize);
+    if(rank<0 || rank>=np || hit[rank]){
+      printf("  %dx%dx%dx%d: calc_rankid(%d,%d,%d,%d)=%d is %s\n",
+             psize[0], psize[1], psize[2], psize[3], c[0], c[1], c[2], c[3], rank,
+             (rank<0 || rank>=np) ? "out of 0..np-1" : "taken twice");
+      err=1;
+      break;
+    }
+    hit[rank]=1;
+    get_rank_coord(back, rank, psize);
+    if(memcmp(back, c, sizeof(c)) != 0){
+      printf("  %dx%dx%dx%d: get_rank_coord(calc_rankid(%d,%d,%d,%d)) = %d,%d,%d,%d\n",
+             psize[0], psize[1], psize[2], psize[3], c[0], c[1], c[2], c[3],
+             back[0], back[1], back[2], back[3]);
+      err=1;
+    }
+  }}}}
+  free(hit);
+
+  int prev[4];
+  get_rank_coord(prev, 0, psize);
+  for(int rank=1; rank<np && unit_step && !err; rank++){
+    get_rank_coord(c, rank, psize);
+    int step=0;
+    for(int i=0; i<4; i++){
+      step += abs(c[i]-prev[i]);
+      prev[i]=c[i];
+    }
+    if(step != 1){
+      printf("  %dx%dx%dx%d: rankid %d is %d hops from rankid %d\n",
+             psize[0], psize[1], psize[2], psize[3], rank, step, rank-1);
+      err=1;
+    }
+  }
+  return err;
+}
+
+// the order on a lattice; blocked with several block sizes
+//   returns the number of the failed cases
+static int check_order(int *cases, const char *name, const int *psize){
+  if(strcmp(name, "blocked") != 0){
+    if(select_rankmap_order(name)){
+      printf("  cannot select: %s\n", name);
+      return 1;
+    }
+    (*cases)++;
+    return check_lattice(psize, strcmp(name, "hilbert") == 0 && power_of_2_cube(psize));
+  }
+
+  int block[3][4];
+  for(int i=0; i<4; i++){
+    block[0][i]=1;
+    block[1][i]=psize[i];
+    for(int d=psize[i]; d>=2; d--){
+      if(psize[i]%d == 0){
+        block[1][i]=d;  // the smallest divisor > 1
+      }
+    }
+    block[2][i]=psize[i];
+  }
+  int failed=0;
+  for(int k=0; k<3; k++){
+    const int *b=block[k];
+    char arg[64];
+    snprintf(arg, sizeof(arg), "blocked:%dx%dx%dx%d", b[0], b[1], b[2], b[3]);
+    if(select_rankmap_order(arg)){
+      printf("  cannot select: %s\n", arg);
+      failed++;
+      continue;
+    }
+    (*cases)++;
+    if(check_rankmap_order(psize)){
+      printf("  %dx%dx%dx%d: %s is rejected\n", psize[0], psize[1], psize[2], psize[3], arg);
+      failed++;
+      continue;
+    }
+    failed+=check_lattice(psize, 0);
+  }
+  return failed;
+}
+
+// block sizes which do not divide the process lattice
+static const struct {
+  const char *order;
+  int psize[4];
+} bad_block[]={
+  {"blocked:3x1x1x1", {8,4,4,4}},
+  {"blocked:1x1x1x2", {4,4,4,3}},
+  {"blocked:2x2x2x2", {4,6,5,4}},
+};
+
+
+int main(void){
+  int failed=0;
+  for(int k=0; rankmap_order_name(k); k++){
+    const char *name=rankmap_order_name(k);
+    int cases=0;
+    int order_failed=0;
+    int psize[4];
+    for(psize[3]=1; psize[3]<=SWEEP_MAX; psize[3]++){
+    for(psize[2]=1; psize[2]<=SWEEP_MAX; psize[2]++){
+    for(psize[1]=1; psize[1]<=SWEEP_MAX; psize[1]++){
+    for(psize[0]=1; psize[0]<=SWEEP_MAX; psize[0]++){
+      order_failed+=check_order(&cases, name, psize);
+    }}}}
+    for(size_t n=0; n<sizeof(extra_lattice)/sizeof(extra_lattice[0]); n++){
+      order_failed+=check_order(&cases, name, extra_lattice[n]);
+    }
+    printf("%-9s %5d cases, %d failed\n", name, cases, order_failed);
+    failed+=order_failed;
+  }
+
+  int order_failed=0;
+  for(size_t n=0; n<sizeof(bad_block)/sizeof(bad_block[0]); n++){
+    const int *psize=bad_block[n].psize;
+    if(select_rankmap_order(bad_block[n].order) || !check_rankmap_order(psize)){
+      printf("  %dx%dx%dx%d: %s is not rejected\n",
+             psize[0], psize[1], psize[2], psize[3], bad_block[n].order);
+      order_failed++;
+    }
+  }
+  printf("%-9s %5d cases, %d failed\n", "bad block", (int)(sizeof(bad_block)/sizeof(bad_block[0])), order_failed);
+  failed+=order_failed;
+  printf("rankmap_4d_test_order: %s\n", failed ? "FAILED" : "passed");
+  return failed;
+}
@@ -0,0 +1,358 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+    2026 Oct. 17 neighbors with the bulk rankid engine
+    2026 Oct. 17 hop distance on the 6-dim Tofu coordinate (--physical)
+    2026 Oct. 17 check_rank_order() fails if the order does not fit the process lattice
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "rankmap_analyze.h"
+#include "rankmap_bulk.h"
+#include "rankmap4d_table.h"
+
+// defined in calc_rankid.c
+int calc_rankid(const int *coords, const int *psize);
+void get_rank_coord(int *coords, int rank, const int *psize);
+int check_rankmap_order(const int *psize);
+extern int rankmap_order;
+
+
+/********************************************************
+ * hop distance between two nodes
+ *   periodic[i]=1: torus, 0: mesh in the i-th direction
+ *   on the Tofu coordinate, each of XYZabc is a torus or a mesh
+ ********************************************************/
+static int node_distance_nd(const int *c1, const int *c2, const int ndim, const int *shape, const int *periodic){
+  int hop=0;
+  for(int i=0; i<ndim; i++){
+    int d = c1[i]-c2[i];
+    if(d<0){ d=-d; }
+    if(periodic[i] && 2*d > shape[i]){
+      d = shape[i]-d;
+    }
+    hop+=d;
+  }
+  return hop;
+}
+
+int node_distance(const int *c1, const int *c2, const int *shape, const int *periodic){
+  return node_distance_nd(c1, c2, 3, shape, periodic);
+}
+
+
+/********************************************************
+ * hop distance to the 8 nearest neighbors of all the ranks
+ *   rank_list[3*rankid + i]: 3-dim node coordinate of rankid
+ *     (node_list[ndim*rankid + i] for analyze_halo_nd)
+ *   the process lattice is periodic in all the 4 directions
+ *   the neighbors are obtained in blocks of HALO_BLOCK ranks
+ ********************************************************/
+#define HALO_BLOCK 65536
+
+void analyze_halo(halo_stat *stat, const int *rank_list, const int *psize,
+                  const int *shape, const int *periodic){
+  analyze_halo_nd(stat, rank_list, 3, psize, shape, periodic);
+}
+
+void analyze_halo_nd(halo_stat *stat, const int *node_list, const int ndim, const int *psize,
+                     const int *shape, const int *periodic){
+  int np=psize[0]*psize[1]*psize[2]*psize[3];
+  stat->np=np;
+  stat->ndim=ndim;
+  int max_distance=0;
+  for(int i=0; i<ndim; i++){
+    stat->shape[i]=shape[i];
+    stat->periodic[i]=periodic[i];
+    max_distance += periodic[i] ? shape[i]/2 : shape[i]-1;
+  }
+  for(int mu=0; mu<4; mu++){
+    stat->psize[mu]=psize[mu];
+  }
+  for(int dir=0; dir<HALO_NDIR; dir++){
+    stat->max_hop[dir]=0;
+    stat->sum_hop[dir]=0;
+    stat->intra_count[dir]=0;
+  }
+  stat->hist_size=max_distance+1;
+  stat->hist=calloc(HALO_NDIR*stat->hist_size, sizeof(long));
+
+  rankid_bulk bulk;
+  rankid_bulk_init(&bulk, psize);
+  int block = (np<HALO_BLOCK) ? np : HALO_BLOCK;
+  int *buf=malloc(sizeof(int)*7*block);
+  int *rank=buf;
+  coords_soa coords;
+  for(int mu=0; mu<4; mu++){
+    coords.c[mu]=buf+(1+mu)*block;
+  }
+  int *shifted=buf+5*block;
+  int *neighbor=buf+6*block;
+
+  for(int rank0=0; rank0<np; rank0+=block){
+    int n = (np-rank0 < block) ? np-rank0 : block;
+    for(int k=0; k<n; k++){
+      rank[k]=rank0+k;
+    }
+    get_rank_coord_bulk(&bulk, &coords, rank, n);
+    for(int dir=0; dir<HALO_NDIR; dir++){
+      int mu=dir/2;
+      int p=psize[mu];
+      int step = (dir%2==0) ? 1 : p-1;
+      const int *c=coords.c[mu];
+      for(int k=0; k<n; k++){
+        int x=c[k]+step;
+        shifted[k] = (x>=p) ? x-p : x;
+      }
+      coords_soa neighbor_coords=coords;
+      neighbor_coords.c[mu]=shifted;
+      calc_rankid_bulk(&bulk, neighbor, &neighbor_coords, n);
+
+      for(int k=0; k<n; k++){
+        int hop=node_distance_nd(node_list+ndim*rank[k], node_list+ndim*neighbor[k], ndim, shape, periodic);
+        if(hop > stat->max_hop[dir]){
+          stat->max_hop[dir]=hop;
+        }
+        stat->sum_hop[dir]+=hop;
+        if(hop==0){
+          stat->intra_count[dir]++;
+        }
+        stat->hist[dir*stat->hist_size+hop]++;
+      }
+    }
+  }
+  free(buf);
+}
+
+
+void print_halo_stat(FILE *fp, const halo_stat *stat){
+  const char sign[2]={'+','-'};
+  int max_all=0;
+  long sum_all=0;
+  long intra_all=0;
+  double np=stat->np;
+
+  const int *s=stat->shape;
+  const int *p=stat->periodic;
+  if(stat->ndim == 6){
+    fprintf(fp, "physical halo hop distance: %dx%dx%dx%d processes on XYZabc %dx%dx%dx%dx%dx%d nodes (periodic: %d%d%d%d%d%d)\n",
+            stat->psize[0], stat->psize[1], stat->psize[2], stat->psize[3],
+            s[0], s[1], s[2], s[3], s[4], s[5], p[0], p[1], p[2], p[3], p[4], p[5]);
+  } else {
+    fprintf(fp, "halo hop distance: %dx%dx%dx%d processes on %dx%dx%d nodes (periodic: %d%d%d)\n",
+            stat->psize[0], stat->psize[1], stat->psize[2], stat->psize[3],
+            s[0], s[1], s[2], p[0], p[1], p[2]);
+  }
+  fprintf(fp, "  dir   max     mean  intra-node  inter-node\n");
+  for(int dir=0; dir<HALO_NDIR; dir++){
+    fprintf(fp, "  %c%d  %4d  %7.3f    %6.2f%%     %6.2f%%\n", sign[dir%2], dir/2+1,
+            stat->max_hop[dir], stat->sum_hop[dir]/np,
+            100.0*stat->intra_count[dir]/np, 100.0*(np-stat->intra_count[dir])/np);
+    if(stat->max_hop[dir]>max_all){
+      max_all=stat->max_hop[dir];
+    }
+    sum_all+=stat->sum_hop[dir];
+    intra_all+=stat->intra_count[dir];
+  }
+  fprintf(fp, "  all %4d  %7.3f    %6.2f%%     %6.2f%%\n", max_all, sum_all/(HALO_NDIR*np),
+          100.0*intra_all/(HALO_NDIR*np), 100.0*(HALO_NDIR*np-intra_all)/(HALO_NDIR*np));
+
+  fprintf(fp, "  histogram (number of messages)\n");
+  fprintf(fp, "  hop");
+  for(int dir=0; dir<HALO_NDIR; dir++){
+    fprintf(fp, "  %8c%d", sign[dir%2], dir/2+1);
+  }
+  fprintf(fp, "\n");
+  for(int hop=0; hop<=max_all; hop++){
+    fprintf(fp, "  %3d", hop);
+    for(int dir=0; dir<HALO_NDIR; dir++){
+      fprintf(fp, "  %9ld", stat->hist[dir*stat->hist_size+hop]);
+    }
+    fprintf(fp, "\n");
+  }
+}
+
+
+/********************************************************
+ * off-node bytes of the halo exchange of all the ranks
+ *   bytes[dir]: for each direction (HALO_NDIR)
+ *   returns the sum over the directions
+ ********************************************************/
+double halo_bytes(double *bytes, const halo_stat *stat, const int *lattice, const int site_bytes){
+  double total=0.0;
+  for(int dir=0; dir<HALO_NDIR; dir++){
+    int mu=dir/2;
+    double face=site_bytes;
+    for(int nu=0; nu<4; nu++){
+      if(nu != mu){
+        face *= lattice[nu]/stat->psize[nu];
+      }
+    }
+    bytes[dir]=face*(stat->np - stat->intra_count[dir]);
+    total+=bytes[dir];
+  }
+  return total;
+}
+
+
+void print_halo_bytes(FILE *fp, const halo_stat *stat, const int *lattice, const int site_bytes){
+  const char sign[2]={'+','-'};
+  double bytes[HALO_NDIR];
+  double total=halo_bytes(bytes, stat, lattice, site_bytes);
+
+  fprintf(fp, "off-node halo bytes per iteration: %dx%dx%dx%d lattice, %d bytes/site\n",
+          lattice[0], lattice[1], lattice[2], lattice[3], site_bytes);
+  fprintf(fp, "  dir  local  off-node msgs    off-node MB\n");
+  for(int dir=0; dir<HALO_NDIR; dir++){
+    fprintf(fp, "  %c%d  %5d  %13ld  %13.3f\n", sign[dir%2], dir/2+1,
+            lattice[dir/2]/stat->psize[dir/2], stat->np - stat->intra_count[dir], bytes[dir]/1.0e6);
+  }
+  fprintf(fp, "  all                       %13.3f\n", total/1.0e6);
+}
+
+
+void free_halo_stat(halo_stat *stat){
+  free(stat->hist);
+  stat->hist=NULL;
+}
+
+
+/********************************************************
+ * round trip of the rankid order
+ *   get_rank_coord() and calc_rankid() must be inverse
+ *   to each other on the process lattice
+ *   returns -1, the first rank which fails, or -2 if the order
+ *   does not fit the process lattice (the reason is printed)
+ ********************************************************/
+int check_rank_order(const int *psize){
+  if(check_rankmap_order(psize)){
+    return -2;
+  }
+  int np=psize[0]*psize[1]*psize[2]*psize[3];
+  for(int rank=0; rank<np; rank++){
+    int coords[4];
+    get_rank_coord(coords, rank, psize);
+    for(int mu=0; mu<4; mu++){
+      if(coords[mu]<0 || coords[mu]>=psize[mu]){
+        return rank;
+      }
+    }
+    if(calc_rankid(coords, psize) != rank){
+      return rank;
+    }
+  }
+  return -1;
+}
+
+
+/********************************************************
+ * binary neighbor table
+ *   the header, then the entries in the rankid order
+ *   written in blocks of the entries
+ ********************************************************/
+int write_neighbor_table(const char *filename, const int *rank_list, const int *psize,
+                         const int *shape, const int *periodic){
+  const int block=4096;
+  int np=psize[0]*psize[1]*psize[2]*psize[3];
+  FILE *fp=fopen(filename, "wb");
+  if(!fp){
+    fprintf(stderr, "cannot open the output file: %s\n", filename);
+    return 1;
+  }
+
+  rankmap4d_table_header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, RANKMAP4D_TABLE_MAGIC, 8);
+  header.version=RANKMAP4D_TABLE_VERSION;
+  header.endian=RANKMAP4D_TABLE_ENDIAN;
+  header.header_size=sizeof(header);
+  header.entry_size=sizeof(rankmap4d_table_entry);
+  header.np=np;
+  header.order=rankmap_order;
+  for(int i=0; i<4; i++){
+    header.psize[i]=psize[i];
+  }
+  for(int i=0; i<3; i++){
+    header.shape[i]=shape[i];
+    header.periodic[i]=periodic[i];
+  }
+  int err = (fwrite(&header, sizeof(header), 1, fp) != 1);
+
+  rankmap4d_table_entry *buf=malloc(sizeof(rankmap4d_table_entry)*block);
+  for(int rank0=0; rank0<np && !err; rank0+=block){
+    int n = (np-rank0 < block) ? np-rank0 : block;
+    for(int k=0; k<n; k++){
+      int rank=rank0+k;
+      rankmap4d_table_entry *e=buf+k;
+      int coords[4];
+      get_rank_coord(coords, rank, psize);
+      for(int mu=0; mu<4; mu++){
+        e->coords[mu]=coords[mu];
+      }
+      for(int i=0; i<3; i++){
+        e->node[i]=rank_list[3*rank+i];
+      }
+      for(int dir=0; dir<HALO_NDIR; dir++){
+        int mu=dir/2;
+        int c=coords[mu];
+        coords[mu] = (dir%2==0) ? (c+1)%psize[mu] : (c-1+psize[mu])%psize[mu];
+        int neighbor=calc_rankid(coords, psize);
+        coords[mu]=c;
+        int hop=node_distance(rank_list+3*rank, rank_list+3*neighbor, shape, periodic);
+        e->neighbor[dir]=neighbor;
+        e->hop[dir] = (hop<255) ? hop : 255;
+      }
+    }
+    err = (fwrite(buf, sizeof(rankmap4d_table_entry), n, fp) != (size_t)n);
+  }
+  free(buf);
+  err |= (fclose(fp) != 0);
+  if(err){
+    fprintf(stderr, "error in writing: %s\n", filename);
+  }
+  return err;
+}
+
+
+/********************************************************
+ * read the rankmap file
+ *   returns 0 if np lines of "(x,y,z)" are read
+ ********************************************************/
+int read_rankmap(int *rank_list, const int np, const char *filename){
+  FILE *fp=fopen(filename, "r");
+  if(!fp){
+    fprintf(stderr, "cannot open the rankmap file: %s\n", filename);
+    return 1;
+  }
+  int n=0;
+  int c[3];
+  while(n<np && fscanf(fp, " (%d,%d,%d)", c, c+1, c+2) == 3){
+    rank_list[3*n  ]=c[0];
+    rank_list[3*n+1]=c[1];
+    rank_list[3*n+2]=c[2];
+    n++;
+  }
+  fclose(fp);
+  if(n != np){
+    fprintf(stderr, "%s: only %d entries are read (np=%d)\n", filename, n, np);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,81 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+    2026 Oct. 17 hop distance on the 6-dim Tofu coordinate
+ */
+#ifndef rankmap_4d_analyze_h
+#define rankmap_4d_analyze_h
+
+#include <stdio.h>
+
+/**************************************************
+
+  hop distance of the nearest neighbor halo exchange
+
+    direction index: 2*mu + (0: forward, 1: backward), mu=0..3
+
+**************************************************/
+#define HALO_NDIR 8
+#define HALO_MAX_NODE_DIM 6      // 3 (logical), or 6 (Tofu XYZabc)
+
+typedef struct {
+  int  np;
+  int  psize[4];
+  int  ndim;                     // dimension of the node coordinate
+  int  shape[HALO_MAX_NODE_DIM];
+  int  periodic[HALO_MAX_NODE_DIM];
+  int  max_hop[HALO_NDIR];
+  long sum_hop[HALO_NDIR];
+  long intra_count[HALO_NDIR];   // the neighbor is on the same node
+  int  hist_size;                // hop = 0, ..., hist_size-1
+  long *hist;                    // hist[dir*hist_size + hop]
+} halo_stat;
+
+int  node_distance(const int *c1, const int *c2, const int *shape, const int *periodic);
+void analyze_halo(halo_stat *stat, const int *rank_list, const int *psize,
+                  const int *shape, const int *periodic);
+// node_list[ndim*rankid + i]: ndim-dim node coordinate, e.g., 6-dim Tofu (--physical)
+void analyze_halo_nd(halo_stat *stat, const int *node_list, const int ndim, const int *psize,
+                     const int *shape, const int *periodic);
+void print_halo_stat(FILE *fp, const halo_stat *stat);
+void free_halo_stat(halo_stat *stat);
+
+/**************************************************
+
+  off-node halo bytes per iteration
+    lattice:    global lattice size, divided by the process size
+    site_bytes: bytes of a site on the halo surface
+
+**************************************************/
+double halo_bytes(double *bytes, const halo_stat *stat, const int *lattice, const int site_bytes);
+void print_halo_bytes(FILE *fp, const halo_stat *stat, const int *lattice, const int site_bytes);
+
+// binary neighbor table (see rankmap4d_table.h); returns 0 if success
+int write_neighbor_table(const char *filename, const int *rank_list, const int *psize,
+                         const int *shape, const int *periodic);
+
+// round trip of calc_rankid() and get_rank_coord(); -1 if it is a bijection,
+//   -2 if the order does not fit the process lattice (blocked)
+int check_rank_order(const int *psize);
+
+// read a rankmap file "(x,y,z)" written by output_rankmap()
+int read_rankmap(int *rank_list, const int np, const char *filename);
+
+#endif
@@ -0,0 +1,238 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "config.h"
+#include "rankmap_4d_core.h"
+#include "rankmap_analyze.h"
+#include "rankmap_auto.h"
+
+
+static const int permutation3[6][3]={
+  {0,1,2}, {0,2,1}, {1,0,2}, {1,2,0}, {2,0,1}, {2,1,0}
+};
+
+static rankmap_candidate *add_candidate(rankmap_candidate *list, int *num, int *capacity,
+                                        const proc_dim *dim, const int *intra, const int notofu_dir,
+                                        const int *dirmap){
+  if(*num == *capacity){
+    *capacity *= 2;
+    list=realloc(list, sizeof(rankmap_candidate)*(*capacity));
+  }
+  rankmap_candidate *c=list+*num;
+  c->dim=*dim;
+  for(int i=0; i<4; i++){
+    c->dim.intra_psize[i]=intra[i];
+    c->dirmap[i]=dirmap[i];
+  }
+  c->dim.notofu_dir=notofu_dir;
+  c->dim.fold.type=FOLD_NONE;
+  c->index=*num;
+  c->mean_hop=0.0;
+  c->max_hop=-1;
+  c->inter_node=0.0;
+  c->offnode_bytes=0.0;
+  (*num)++;
+  return list;
+}
+
+
+/********************************************************
+ * all the valid combinations
+ *   intra_psize: divides psize, and the product is ppn
+ *   notofu_dir:  a direction of which node lattice size is 1
+ *   dirmap:      any permutation of the 3-dim node axes
+ *                that matches the node lattice
+ ********************************************************/
+rankmap_candidate *enumerate_candidates(int *num, const proc_dim *dim,
+                                        const int *shape_fjmpi, const int mode){
+  const int *psize=dim->psize;
+  const int ppn=dim->ppn;
+  int capacity=16;
+  rankmap_candidate *list=malloc(sizeof(rankmap_candidate)*capacity);
+  *num=0;
+
+  int intra[4];
+  for(intra[0]=1; intra[0]<=ppn; intra[0]++){
+  for(intra[1]=1; intra[1]<=ppn/intra[0]; intra[1]++){
+  for(intra[2]=1; intra[2]<=ppn/(intra[0]*intra[1]); intra[2]++){
+    if(ppn % (intra[0]*intra[1]*intra[2]) != 0){ continue; }
+    intra[3]=ppn/(intra[0]*intra[1]*intra[2]);
+    int ok=1;
+    int split_dirs=0;
+    int node_size[4];
+    for(int i=0; i<4; i++){
+      if(psize[i] % intra[i] != 0){ ok=0; }
+      if(intra[i]>1){ split_dirs++; }
+      node_size[i]=psize[i]/intra[i];
+    }
+    if(!ok){ continue; }
+    if(mode == AUTO_SINGLE_DIR && split_dirs > 1){ continue; }
+
+    for(int notofu=0; notofu<4; notofu++){
+      if(node_size[notofu] != 1){ continue; }
+      int dirs[3];
+      int k=0;
+      for(int i=0; i<4; i++){
+        if(i != notofu){ dirs[k++]=i; }
+      }
+      for(int p=0; p<6; p++){
+        int dirmap[4];
+        int match=1;
+        dirmap[notofu]=3;
+        for(k=0; k<3; k++){
+          int fjdir=permutation3[p][k];
+          if(node_size[dirs[k]] != shape_fjmpi[fjdir]){ match=0; }
+          dirmap[dirs[k]]=fjdir;
+        }
+        if(match){
+          list=add_candidate(list, num, &capacity, dim, intra, notofu, dirmap);
+        }
+      } // p
+    } // notofu
+  }}}
+  return list;
+}
+
+
+/********************************************************
+ * hop distance of each candidate
+ *   node_list[3*rank + i]: 3-dim node coordinate of MPI rank
+ ********************************************************/
+void evaluate_candidates(rankmap_candidate *list, const int num, const int *node_list,
+                         const int *shape_fjmpi){
+  int *rank_list=malloc(sizeof(int)*3*np);
+  for(int n=0; n<num; n++){
+    rankmap_candidate *c=list+n;
+    build_rank_list(rank_list, node_list, shape_fjmpi, c->dirmap, &c->dim);
+    if(check_rank_list(rank_list, shape_fjmpi) >= 0){
+      c->max_hop=-1;  // invalid
+      continue;
+    }
+    halo_stat stat;
+    analyze_halo(&stat, rank_list, c->dim.psize, shape_fjmpi, c->dim.periodic);
+    long sum=0;
+    long intra=0;
+    c->max_hop=0;
+    for(int dir=0; dir<HALO_NDIR; dir++){
+      sum+=stat.sum_hop[dir];
+      intra+=stat.intra_count[dir];
+      if(stat.max_hop[dir] > c->max_hop){
+        c->max_hop=stat.max_hop[dir];
+      }
+    }
+    c->mean_hop=(double)sum/(HALO_NDIR*(double)np);
+    c->inter_node=1.0-(double)intra/(HALO_NDIR*(double)np);
+    if(c->dim.lattice[0]>0){
+      double bytes[HALO_NDIR];
+      c->offnode_bytes=halo_bytes(bytes, &stat, c->dim.lattice, c->dim.site_bytes);
+    }
+    free_halo_stat(&stat);
+  }
+  free(rank_list);
+}
+
+
+// fewer off-node bytes (if the lattice is given), smaller mean hop, smaller max hop,
+// fewer inter-node messages; invalid ones are the last
+static int compare_candidates(const void *a, const void *b){
+  const rankmap_candidate *c1=a;
+  const rankmap_candidate *c2=b;
+  if((c1->max_hop<0) != (c2->max_hop<0)){
+    return (c1->max_hop<0) ? 1 : -1;
+  }
+  if(c1->offnode_bytes != c2->offnode_bytes){
+    return (c1->offnode_bytes < c2->offnode_bytes) ? -1 : 1;
+  }
+  if(c1->mean_hop   != c2->mean_hop)  { return (c1->mean_hop   < c2->mean_hop)   ? -1 : 1; }
+  if(c1->max_hop    != c2->max_hop)   { return (c1->max_hop    < c2->max_hop)    ? -1 : 1; }
+  if(c1->inter_node != c2->inter_node){ return (c1->inter_node < c2->inter_node) ? -1 : 1; }
+  return c1->index - c2->index;
+}
+
+
+void print_candidates(FILE *fp, const rankmap_candidate *list, const int num){
+  const char axis[4]={'x','y','z','-'};
+  int with_bytes=(num>0 && list[0].dim.lattice[0]>0);
+  fprintf(fp, "  rank  intra-node  node axis  mean hop  max hop  inter-node%s\n",
+          with_bytes ? "  off-node MB" : "");
+  for(int n=0; n<num; n++){
+    const rankmap_candidate *c=list+n;
+    fprintf(fp, "  %4d  %dx%dx%dx%d     %c %c %c %c", n+1,
+            c->dim.intra_psize[0], c->dim.intra_psize[1], c->dim.intra_psize[2], c->dim.intra_psize[3],
+            axis[c->dirmap[0]], axis[c->dirmap[1]], axis[c->dirmap[2]], axis[c->dirmap[3]]);
+    if(c->max_hop<0){
+      fprintf(fp, "   (cannot map)\n");
+      continue;
+    }
+    fprintf(fp, "  %8.3f  %7d     %6.2f%%", c->mean_hop, c->max_hop, 100.0*c->inter_node);
+    if(with_bytes){
+      fprintf(fp, "  %11.3f", c->offnode_bytes/1.0e6);
+    }
+    fprintf(fp, "\n");
+  }
+}
+
+
+/********************************************************
+ * automatic search
+ *   the ranked summary is printed and written to RANK_MAP_AUTO_FILE
+ *   returns the number of the valid candidates
+ ********************************************************/
+int search_candidates(rankmap_candidate *best, const proc_dim *dim, const int *node_list,
+                      const int *shape_fjmpi, const int mode){
+  const int *psize=dim->psize;
+  const int ppn=dim->ppn;
+  int num=0;
+  rankmap_candidate *list=enumerate_candidates(&num, dim, shape_fjmpi, mode);
+  evaluate_candidates(list, num, node_list, shape_fjmpi);
+  qsort(list, num, sizeof(rankmap_candidate), compare_candidates);
+
+  int num_valid=0;
+  for(int n=0; n<num; n++){
+    if(list[n].max_hop >= 0){ num_valid++; }
+  }
+
+  printf("automatic search: %d candidates for %dx%dx%dx%d processes on %dx%dx%d nodes, %d processes/node\n",
+         num, psize[0], psize[1], psize[2], psize[3], shape_fjmpi[0], shape_fjmpi[1], shape_fjmpi[2], ppn);
+  print_candidates(stdout, list, num);
+
+  const char *filename=RANK_MAP_AUTO_FILE;
+  remove(filename);  // may be a hard link to the cache
+  FILE *fp=fopen(filename, "w");
+  if(fp){
+    fprintf(fp, "# %dx%dx%dx%d processes on %dx%dx%d nodes, %d processes/node, using %s\n",
+            psize[0], psize[1], psize[2], psize[3], shape_fjmpi[0], shape_fjmpi[1], shape_fjmpi[2],
+            ppn, rankmap_name);
+    print_candidates(fp, list, num);
+    fclose(fp);
+    printf("summary of the automatic search: %s\n", filename);
+  } else {
+    fprintf(stderr, "cannot open the output file: %s\n", filename);
+  }
+
+  if(num_valid>0){
+    *best=list[0];
+  }
+  free(list);
+  return num_valid;
+}
@@ -0,0 +1,60 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+ */
+#ifndef rankmap_4d_auto_h
+#define rankmap_4d_auto_h
+
+#include <stdio.h>
+#include "rankmap_4d_core.h"
+
+/**************************************************
+
+  automatic search of the map
+    enumerates all the valid combinations of
+      (intra-node process lattice, notofu direction, direction map)
+    and ranks them with the hop distance of the halo exchange
+
+**************************************************/
+#define AUTO_OFF        0
+#define AUTO_ANY_SPLIT  1   // any intra-node process lattice (rankmap_4d_general)
+#define AUTO_SINGLE_DIR 2   // intra-node processes in a single direction (rankmap_4d)
+
+typedef struct {
+  proc_dim dim;
+  int dirmap[4];
+  int index;          // order in the enumeration
+  double mean_hop;
+  int max_hop;
+  double inter_node;  // fraction of the inter-node messages
+  double offnode_bytes;  // off-node halo bytes (0 if the lattice is not given)
+} rankmap_candidate;
+
+rankmap_candidate *enumerate_candidates(int *num, const proc_dim *dim,
+                                        const int *shape_fjmpi, const int mode);
+void evaluate_candidates(rankmap_candidate *list, const int num, const int *node_list,
+                         const int *shape_fjmpi);
+void print_candidates(FILE *fp, const rankmap_candidate *list, const int num);
+
+// enumerate, evaluate, sort, and report; returns the number of the candidates
+int search_candidates(rankmap_candidate *best, const proc_dim *dim, const int *node_list,
+                      const int *shape_fjmpi, const int mode);
+
+#endif
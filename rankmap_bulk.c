@@ -0,0 +1,158 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+ */
+#include <stdlib.h>
+#include "rankmap_bulk.h"
+
+// defined in calc_rankid.c
+int calc_rankid(const int *coords, const int *psize);
+void get_rank_coord(int *coords, int rank, const int *psize);
+extern int rankmap_order;
+
+// samples to check the engine against the scalar functions
+#define RANKID_BULK_SAMPLES 4096
+
+
+static void set_digits(rankid_bulk *b, const int *digit){
+  int stride=1;
+  for(int k=0; k<4; k++){
+    int mu=digit[k];
+    b->digit[k]=mu;
+    b->stride[mu]=stride;
+    fast_div_init(&b->div[k], b->psize[mu]);
+    stride*=b->psize[mu];
+  }
+}
+
+
+// the mixed radix must give the same rankid as calc_rankid()
+static int check_mixed_radix(const rankid_bulk *b){
+  const int *p=b->psize;
+  long np=(long)p[0]*p[1]*p[2]*p[3];
+  long step = (np > RANKID_BULK_SAMPLES) ? np/RANKID_BULK_SAMPLES : 1;
+  for(long r=0; r<np; r+=step){
+    int rank = (int)r;
+    int coords[4];
+    int tmp=rank;
+    for(int k=0; k<4; k++){
+      int q = (k<3) ? fast_div_q(&b->div[k], tmp) : 0;
+      coords[b->digit[k]] = (k<3) ? tmp - q*p[b->digit[k]] : tmp;
+      tmp=q;
+    }
+    int expected[4];
+    get_rank_coord(expected, rank, p);
+    for(int mu=0; mu<4; mu++){
+      if(coords[mu] != expected[mu]){ return 1; }
+    }
+    if(calc_rankid(coords, p) != rank){ return 1; }
+  }
+  return 0;
+}
+
+
+void rankid_bulk_init(rankid_bulk *b, const int *psize){
+  static const int lex[4]={0,1,2,3};
+  static const int reversed[4]={3,2,1,0};
+  for(int mu=0; mu<4; mu++){
+    b->psize[mu]=psize[mu];
+  }
+  b->kind=RANKID_BULK_SCALAR;
+  if(rankmap_order == 0 || rankmap_order == 1){
+    set_digits(b, (rankmap_order == 0) ? lex : reversed);
+    if(check_mixed_radix(b) == 0){
+      b->kind=RANKID_BULK_MIXED_RADIX;
+    }
+  }
+}
+
+
+void calc_rankid_bulk(const rankid_bulk *b, int *rank, const coords_soa *coords, const long n){
+  const int *restrict c0=coords->c[0];
+  const int *restrict c1=coords->c[1];
+  const int *restrict c2=coords->c[2];
+  const int *restrict c3=coords->c[3];
+  int *restrict r=rank;
+
+  if(b->kind == RANKID_BULK_SCALAR){
+    const int *psize=b->psize;
+#pragma omp parallel for schedule(static)
+    for(long i=0; i<n; i++){
+      int c[4]={c0[i], c1[i], c2[i], c3[i]};
+      r[i]=calc_rankid(c, psize);
+    }
+    return;
+  }
+
+  const int s0=b->stride[0];
+  const int s1=b->stride[1];
+  const int s2=b->stride[2];
+  const int s3=b->stride[3];
+#pragma omp parallel for simd schedule(static)
+  for(long i=0; i<n; i++){
+    r[i]=c0[i]*s0 + c1[i]*s1 + c2[i]*s2 + c3[i]*s3;
+  }
+}
+
+
+void get_rank_coord_bulk(const rankid_bulk *b, const coords_soa *coords, const int *rank, const long n){
+  const int *restrict r=rank;
+
+  if(b->kind == RANKID_BULK_SCALAR){
+    int *restrict c0=coords->c[0];
+    int *restrict c1=coords->c[1];
+    int *restrict c2=coords->c[2];
+    int *restrict c3=coords->c[3];
+    const int *psize=b->psize;
+#pragma omp parallel for schedule(static)
+    for(long i=0; i<n; i++){
+      int c[4];
+      get_rank_coord(c, r[i], psize);
+      c0[i]=c[0];
+      c1[i]=c[1];
+      c2[i]=c[2];
+      c3[i]=c[3];
+    }
+    return;
+  }
+
+  // digits from the fastest one
+  int *restrict d0=coords->c[b->digit[0]];
+  int *restrict d1=coords->c[b->digit[1]];
+  int *restrict d2=coords->c[b->digit[2]];
+  int *restrict d3=coords->c[b->digit[3]];
+  const int p0=b->psize[b->digit[0]];
+  const int p1=b->psize[b->digit[1]];
+  const int p2=b->psize[b->digit[2]];
+  const fast_div f0=b->div[0];
+  const fast_div f1=b->div[1];
+  const fast_div f2=b->div[2];
+#pragma omp parallel for simd schedule(static)
+  for(long i=0; i<n; i++){
+    int x=r[i];
+    int q0=fast_div_q(&f0, x);
+    int q1=fast_div_q(&f1, q0);
+    int q2=fast_div_q(&f2, q1);
+    d0[i]=x  - q0*p0;
+    d1[i]=q0 - q1*p1;
+    d2[i]=q1 - q2*p2;
+    d3[i]=q2;
+  }
+}
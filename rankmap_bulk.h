@@ -0,0 +1,84 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+ */
+#ifndef rankmap_4d_bulk_h
+#define rankmap_4d_bulk_h
+
+#include <stdint.h>
+
+/**************************************************
+
+  division by a constant with a precomputed reciprocal
+    q = (n * mul) >> shift,  shift = 31 + ceil(log2(d)),
+    mul = ceil(2^shift / d)
+    exact for 0 <= n < 2^31, and n * mul fits in 64 bits
+
+**************************************************/
+typedef struct {
+  uint64_t mul;
+  int shift;
+} fast_div;
+
+static inline void fast_div_init(fast_div *f, const int d){
+  int l=0;
+  while((1L<<l) < d){
+    l++;
+  }
+  f->shift=31+l;
+  f->mul=((UINT64_C(1)<<f->shift) + d - 1)/d;
+}
+
+static inline int fast_div_q(const fast_div *f, const int n){
+  return (int)(((uint64_t)n * f->mul) >> f->shift);
+}
+
+
+/**************************************************
+
+  bulk rankid engine
+    structure of arrays: coords->c[mu][i] is the mu-th process
+    coordinate of the i-th element
+    the lex and reversed orders use the mixed radix with fast_div;
+    the other orders of calc_rankid() are called element by element
+    the loops run with OpenMP, if enabled
+
+**************************************************/
+#define RANKID_BULK_SCALAR       0   // calls calc_rankid()/get_rank_coord()
+#define RANKID_BULK_MIXED_RADIX  1
+
+typedef struct {
+  int *c[4];
+} coords_soa;
+
+typedef struct {
+  int kind;          // RANKID_BULK_*
+  int psize[4];
+  int digit[4];      // direction of the k-th fastest digit of the rankid
+  int stride[4];     // rankid = sum_mu coords[mu]*stride[mu]
+  fast_div div[4];   // division by psize[digit[k]]
+} rankid_bulk;
+
+// the kind is chosen from rankmap_order and checked against calc_rankid()
+void rankid_bulk_init(rankid_bulk *b, const int *psize);
+void calc_rankid_bulk(const rankid_bulk *b, int *rank, const coords_soa *coords, const long n);
+void get_rank_coord_bulk(const rankid_bulk *b, const coords_soa *coords, const int *rank, const long n);
+
+#endif
@@ -0,0 +1,209 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "config.h"
+#include "rankmap_cache.h"
+
+#define CACHE_PATH_MAX 4096
+
+
+void rankmap_cache_key(char *key, const proc_dim *dim, const int *shape,
+                       const int *periodic, const int auto_mode){
+  const int *p=dim->psize;
+  const int *in=dim->intra_psize;
+  const int *g=dim->periodic;
+  const int *l=dim->lattice;
+  snprintf(key, RANKMAP_CACHE_KEY_MAX,
+           "rankmap_4d cache %d\n"
+           "shape %d %d %d\n"
+           "periodic %d %d %d given %d %d %d\n"
+           "psize %d %d %d %d\n"
+           "intra_psize %d %d %d %d\n"
+           "notofu_dir %d\n"
+           "ppn %d\n"
+           "lattice %d %d %d %d site_bytes %d\n"
+           "auto %d\n"
+           "rankmap %s\n",
+           RANKMAP_CACHE_VERSION,
+           shape[0], shape[1], shape[2],
+           periodic[0], periodic[1], periodic[2], g[0], g[1], g[2],
+           p[0], p[1], p[2], p[3],
+           in[0], in[1], in[2], in[3],
+           dim->notofu_dir,
+           dim->ppn,
+           l[0], l[1], l[2], l[3], dim->site_bytes,
+           auto_mode,
+           rankmap_name);
+}
+
+
+// 64-bit FNV-1a
+static uint64_t fnv1a(const char *s){
+  uint64_t h=UINT64_C(14695981039346656037);
+  for(; *s; s++){
+    h ^= (unsigned char)*s;
+    h *= UINT64_C(1099511628211);
+  }
+  return h;
+}
+
+static void cache_path(char *path, const char *dir, const char *key, const char *ext){
+  snprintf(path, CACHE_PATH_MAX, "%s/%016llx.%s", dir, (unsigned long long)fnv1a(key), ext);
+}
+
+
+static int copy_file(const char *src, const char *dst){
+  FILE *in=fopen(src, "rb");
+  if(!in){ return 1; }
+  FILE *out=fopen(dst, "wb");
+  if(!out){
+    fclose(in);
+    return 1;
+  }
+  char *buf=malloc(1<<20);
+  size_t n;
+  int err=0;
+  while(!err && (n=fread(buf, 1, 1<<20, in)) > 0){
+    err = (fwrite(buf, 1, n, out) != n);
+  }
+  err |= ferror(in);
+  free(buf);
+  fclose(in);
+  err |= (fclose(out) != 0);
+  return err;
+}
+
+// dst becomes a hard link to src, or a copy on another file system
+static int place_file(const char *src, const char *dst){
+  remove(dst);
+  if(link(src, dst) == 0){
+    return 0;
+  }
+  return copy_file(src, dst);
+}
+
+// temporary name in the cache, unique among the jobs
+static void temp_path(char *tmp, const char *dst){
+  char host[64]="";
+  gethostname(host, sizeof(host)-1);
+  snprintf(tmp, CACHE_PATH_MAX+128, "%s.tmp.%s.%ld", dst, host, (long)getpid());
+}
+
+static int commit_file(const char *tmp, const char *dst, int err){
+  if(!err && rename(tmp, dst) != 0){
+    err=1;
+  }
+  if(err){
+    remove(tmp);
+  }
+  return err;
+}
+
+// src is copied to a temporary name, then renamed to dst
+static int store_file(const char *src, const char *dst){
+  char tmp[CACHE_PATH_MAX+128];
+  temp_path(tmp, dst);
+  return commit_file(tmp, dst, copy_file(src, tmp));
+}
+
+static int store_text(const char *text, const char *dst){
+  char tmp[CACHE_PATH_MAX+128];
+  temp_path(tmp, dst);
+  FILE *fp=fopen(tmp, "w");
+  if(!fp){ return 1; }
+  int err = (fputs(text, fp) < 0);
+  err |= (fclose(fp) != 0);
+  return commit_file(tmp, dst, err);
+}
+
+
+int rankmap_cache_lookup(const char *dir, const char *key, const int with_auto){
+  char path[CACHE_PATH_MAX];
+
+  // the key must be the same (not only the hash)
+  cache_path(path, dir, key, "key");
+  FILE *fp=fopen(path, "r");
+  if(!fp){
+    return 0;
+  }
+  char stored[RANKMAP_CACHE_KEY_MAX];
+  size_t n=fread(stored, 1, RANKMAP_CACHE_KEY_MAX-1, fp);
+  fclose(fp);
+  stored[n]='\0';
+  if(strcmp(stored, key) != 0){
+    printf("rankmap cache: hash collision, not used: %s\n", path);
+    return 0;
+  }
+
+  char list[CACHE_PATH_MAX];
+  cache_path(list, dir, key, "list");
+  if(access(list, R_OK) != 0){
+    return 0;  // being stored by another job
+  }
+  if(with_auto){
+    cache_path(path, dir, key, "auto");
+    if(place_file(path, RANK_MAP_AUTO_FILE) != 0){
+      return 0;
+    }
+  }
+  if(place_file(list, RANK_MAP_FILE) != 0){
+    return 0;
+  }
+  printf("rankmap cache: hit %s\n", list);
+  return 1;
+}
+
+
+int rankmap_cache_store(const char *dir, const char *key, const int with_auto){
+  char path[CACHE_PATH_MAX];
+  if(mkdir(dir, 0777) != 0 && errno != EEXIST){
+    fprintf(stderr, "rankmap cache: cannot create %s\n", dir);
+    return 1;
+  }
+
+  int err=0;
+  if(with_auto){
+    cache_path(path, dir, key, "auto");
+    err |= store_file(RANK_MAP_AUTO_FILE, path);
+  }
+
+  cache_path(path, dir, key, "key");
+  err |= store_text(key, path);
+
+  // the last one: the entry is complete
+  if(!err){
+    cache_path(path, dir, key, "list");
+    err |= store_file(RANK_MAP_FILE, path);
+  }
+  if(err){
+    fprintf(stderr, "rankmap cache: cannot store in %s\n", dir);
+  } else {
+    printf("rankmap cache: stored %s\n", path);
+  }
+  return err;
+}
@@ -0,0 +1,53 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+ */
+#ifndef rankmap_4d_cache_h
+#define rankmap_4d_cache_h
+
+#include "rankmap_4d_core.h"
+
+/**************************************************
+
+  content-addressed cache of the generated rankmap files
+    key:  text of all the inputs that determine the map
+    file: DIR/HASH.list (RANK_MAP_FILE), DIR/HASH.auto (RANK_MAP_AUTO_FILE)
+          and DIR/HASH.key (the key, to detect a hash collision)
+          HASH = 64-bit FNV-1a of the key, in hex
+    each file is written to a temporary name and renamed, and
+    HASH.list is the last one, so that the jobs sharing the
+    directory see either a complete entry or nothing
+    a hit makes hard links (or copies) of the files
+
+**************************************************/
+#define RANKMAP_CACHE_VERSION 1
+#define RANKMAP_CACHE_KEY_MAX 1024
+
+// periodic: of the topology (dim->periodic is the given one)
+void rankmap_cache_key(char *key, const proc_dim *dim, const int *shape,
+                       const int *periodic, const int auto_mode);
+
+// returns 1 if the files are taken from the cache
+int rankmap_cache_lookup(const char *dir, const char *key, const int with_auto);
+
+// returns 0 if success
+int rankmap_cache_store(const char *dir, const char *key, const int with_auto);
+
+#endif
@@ -0,0 +1,288 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "rankmap_analyze.h"
+#include "rankmap_congestion.h"
+#include "rankmap_cmg.h"
+
+
+// steps on the ring bus: CMG c at (c%2, c/2)
+static int cmg_distance(const int a, const int b){
+  return abs(a%2 - b%2) + abs(a/2 - b/2);
+}
+
+
+// intra-node coordinate of the lexical intra-node index, as calc_proc_coords()
+static void intra_coords(int *c, int intra, const int *intra_psize){
+  for(int i=0; i<4; i++){
+    c[i]=intra % intra_psize[i];
+    intra /= intra_psize[i];
+  }
+}
+
+static int intra_index(const int *c, const int *intra_psize){
+  return c[0] + intra_psize[0]*(c[1] + intra_psize[1]*(c[2] + intra_psize[2]*c[3]));
+}
+
+
+/********************************************************
+ * halo bytes between the CMGs x distance in a node
+ *   cmg[intra]: the CMG of each intra-node index
+ *   the neighbor is in the node if it is in the intra-node
+ *   lattice, or by the wrap around if the whole direction
+ *   is in the node
+ ********************************************************/
+static double halo_cost(const int *cmg, const proc_dim *dim, const double *msg_bytes){
+  const int *ip=dim->intra_psize;
+  double cost=0.0;
+  for(int k=0; k<dim->ppn; k++){
+    int c[4];
+    intra_coords(c, k, ip);
+    for(int dir=0; dir<HALO_NDIR; dir++){
+      int mu=dir/2;
+      int n[4]={c[0], c[1], c[2], c[3]};
+      n[mu] += (dir%2==0) ? 1 : -1;
+      if(n[mu]<0 || n[mu]>=ip[mu]){
+        if(ip[mu] != dim->psize[mu]){ continue; }  // in the other node
+        n[mu]=(n[mu]+ip[mu]) % ip[mu];
+      }
+      cost += msg_bytes[dir]*cmg_distance(cmg[k], cmg[intra_index(n, ip)]);
+    }
+  }
+  return cost;
+}
+
+
+// CMG of the intra-node index for the CMG blocks grid[] and the CMG of each block
+static void block_cmg(int *cmg, const int *grid, const int *cmg_of_block, const proc_dim *dim){
+  const int *ip=dim->intra_psize;
+  for(int k=0; k<dim->ppn; k++){
+    int c[4];
+    intra_coords(c, k, ip);
+    int b[4];
+    for(int i=0; i<4; i++){
+      b[i]=c[i]/(ip[i]/grid[i]);
+    }
+    cmg[k]=cmg_of_block[intra_index(b, grid)];
+  }
+}
+
+
+// next permutation in the lexical order, 0 after the last one
+static int next_permutation(int *p, const int n){
+  int i=n-2;
+  while(i>=0 && p[i]>=p[i+1]){ i--; }
+  if(i<0){ return 0; }
+  int j=n-1;
+  while(p[j]<=p[i]){ j--; }
+  int t=p[i]; p[i]=p[j]; p[j]=t;
+  for(int l=i+1, r=n-1; l<r; l++, r--){
+    t=p[l]; p[l]=p[r]; p[r]=t;
+  }
+  return 1;
+}
+
+
+/********************************************************
+ * mean cost per node of the CMGs in the rankid order,
+ * i.e., without the binding file: the k-th smallest rankid
+ * in a node goes to the k-th slot
+ ********************************************************/
+static double default_cost(const cmg_map *map, const proc_dim *dim, const double *msg_bytes){
+  const int ppn=dim->ppn;
+  int nsize[4];
+  for(int i=0; i<4; i++){
+    nsize[i]=dim->psize[i]/dim->intra_psize[i];
+  }
+  const int num_nodes=nsize[0]*nsize[1]*nsize[2]*nsize[3];
+  int *rankid=malloc(sizeof(int)*ppn);
+  int *cmg=malloc(sizeof(int)*ppn);
+  double sum=0.0;
+  for(int node=0; node<num_nodes; node++){
+    int nc[4];
+    intra_coords(nc, node, nsize);
+    for(int k=0; k<ppn; k++){
+      int c[4];
+      intra_coords(c, k, dim->intra_psize);
+      for(int i=0; i<4; i++){
+        c[i] += dim->intra_psize[i]*nc[i];
+      }
+      rankid[k]=calc_rankid(c, dim->psize);
+    }
+    for(int k=0; k<ppn; k++){
+      int order=0;
+      for(int l=0; l<ppn; l++){
+        order += (rankid[l] < rankid[k]);
+      }
+      cmg[k] = (map->ranks_per_cmg>0) ? order/map->ranks_per_cmg : order*map->cmgs_per_rank;
+    }
+    sum += halo_cost(cmg, dim, msg_bytes);
+  }
+  free(rankid);
+  free(cmg);
+  return sum/num_nodes;
+}
+
+
+int set_cmg_map(cmg_map *map, const proc_dim *dim){
+  const int ppn=dim->ppn;
+  map->ppn=ppn;
+  map->cmg=NULL;
+  map->slot=NULL;
+  if(dim->fallback){
+    return -1;  // no intra-node process lattice
+  }
+  map->ranks_per_cmg = (ppn%CMG_NUM==0) ? ppn/CMG_NUM : 0;
+  map->cmgs_per_rank = (map->ranks_per_cmg==0 && CMG_NUM%ppn==0) ? CMG_NUM/ppn : 0;
+  if((map->ranks_per_cmg==0 && map->cmgs_per_rank==0) || map->ranks_per_cmg > CMG_CORES){
+    return -1;
+  }
+  map->cmg=malloc(sizeof(int)*ppn);
+  map->slot=malloc(sizeof(int)*ppn);
+  double msg_bytes[HALO_NDIR];
+  map->unit=halo_message_bytes(msg_bytes, dim->psize, dim->lattice, dim->site_bytes);
+
+  for(int i=0; i<4; i++){
+    map->grid[i]=1;
+  }
+  for(int c=0; c<CMG_NUM; c++){
+    map->block[c]=c;
+  }
+  if(map->cmgs_per_rank>0){
+    // a process takes the whole CMGs
+    for(int k=0; k<ppn; k++){
+      map->cmg[k]=k*map->cmgs_per_rank;
+    }
+  } else {
+    // all the divisions of the intra-node lattice into CMG_NUM blocks,
+    // and all the assignments of the blocks to the CMGs
+    int *cmg=malloc(sizeof(int)*ppn);
+    double best=-1.0;
+    int g[4];
+    for(g[3]=1; g[3]<=CMG_NUM; g[3]++){
+      for(g[2]=1; g[2]<=CMG_NUM; g[2]++){
+        for(g[1]=1; g[1]<=CMG_NUM; g[1]++){
+          for(g[0]=1; g[0]<=CMG_NUM; g[0]++){
+            if(g[0]*g[1]*g[2]*g[3] != CMG_NUM){ continue; }
+            int ok=1;
+            for(int i=0; i<4; i++){
+              ok = ok && (dim->intra_psize[i] % g[i] == 0);
+            }
+            if(!ok){ continue; }
+            int perm[CMG_NUM];
+            for(int c=0; c<CMG_NUM; c++){
+              perm[c]=c;
+            }
+            do {
+              block_cmg(cmg, g, perm, dim);
+              double cost=halo_cost(cmg, dim, msg_bytes);
+              if(best<0 || cost<best){
+                best=cost;
+                for(int i=0; i<4; i++){
+                  map->grid[i]=g[i];
+                }
+                for(int c=0; c<CMG_NUM; c++){
+                  map->block[perm[c]]=c;
+                }
+                for(int k=0; k<ppn; k++){
+                  map->cmg[k]=cmg[k];
+                }
+              }
+            } while(next_permutation(perm, CMG_NUM));
+          }
+        }
+      }
+    }
+    free(cmg);
+  }
+
+  // the order in each CMG
+  int count[CMG_NUM]={0};
+  for(int k=0; k<ppn; k++){
+    map->slot[k]=count[map->cmg[k]]++;
+  }
+  map->cost=halo_cost(map->cmg, dim, msg_bytes);
+  map->cost_default=default_cost(map, dim, msg_bytes);
+  return 0;
+}
+
+
+void print_cmg_map(FILE *fp, const cmg_map *map, const proc_dim *dim){
+  const int *ip=dim->intra_psize;
+  fprintf(fp, "CMG placement: %d processes/node on %d CMGs\n", map->ppn, CMG_NUM);
+  if(map->cmgs_per_rank>0){
+    for(int k=0; k<map->ppn; k++){
+      fprintf(fp, "  process %d: CMG %d-%d\n", k, map->cmg[k], map->cmg[k]+map->cmgs_per_rank-1);
+    }
+  } else {
+    for(int c=0; c<CMG_NUM; c++){
+      int b[4];
+      intra_coords(b, map->block[c], map->grid);
+      fprintf(fp, "  CMG %d:", c);
+      for(int i=0; i<4; i++){
+        int s=ip[i]/map->grid[i];
+        fprintf(fp, "%s%d-%d", (i==0) ? " " : " x ", s*b[i], s*(b[i]+1)-1);
+      }
+      fprintf(fp, "\n");
+    }
+  }
+  fprintf(fp, "  halo %s between the CMGs x distance, per node: %.6g (in the rankid order: %.6g)\n",
+          map->unit, map->cost, map->cost_default);
+}
+
+
+int write_binding(const char *file, const cmg_map *map, const proc_dim *dim){
+  FILE *fp=fopen(file, "w");
+  if(!fp){
+    return -1;
+  }
+  fprintf(fp, "# rankid cmg cpus mems\n");
+  for(int rankid=0; rankid<np; rankid++){
+    int c[4];
+    get_rank_coord(c, rankid, dim->psize);
+    for(int i=0; i<4; i++){
+      c[i] %= dim->intra_psize[i];
+    }
+    int k=intra_index(c, dim->intra_psize);
+    int cmg=map->cmg[k];
+    if(map->ranks_per_cmg>0){
+      int cores=CMG_CORES/map->ranks_per_cmg;
+      int first=CMG_FIRST_CORE + CMG_CORES*cmg + cores*map->slot[k];
+      fprintf(fp, "%d %d %d-%d %d\n", rankid, cmg, first, first+cores-1, CMG_FIRST_MEM+cmg);
+    } else {
+      int n=map->cmgs_per_rank;
+      int first=CMG_FIRST_CORE + CMG_CORES*cmg;
+      fprintf(fp, "%d %d %d-%d %d-%d\n", rankid, cmg, first, first+n*CMG_CORES-1,
+              CMG_FIRST_MEM+cmg, CMG_FIRST_MEM+cmg+n-1);
+    }
+  }
+  return fclose(fp)==0 ? 0 : -1;
+}
+
+
+void free_cmg_map(cmg_map *map){
+  free(map->cmg);
+  free(map->slot);
+  map->cmg=NULL;
+  map->slot=NULL;
+}
@@ -0,0 +1,68 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+ */
+#ifndef rankmap_4d_cmg_h
+#define rankmap_4d_cmg_h
+
+#include <stdio.h>
+#include "config.h"
+#include "rankmap_4d_core.h"
+
+/**************************************************
+
+  placement of the intra-node processes on the CMGs (--bind)
+    the intra-node process lattice is divided into CMG_NUM blocks
+    (grid[0] x grid[1] x grid[2] x grid[3] = CMG_NUM), and the blocks
+    are assigned to the CMGs so that the halo bytes between the
+    processes in a node, weighted with the distance of the CMGs, are
+    the smallest.  The CMGs are 2 x (CMG_NUM/2) on the ring bus:
+    CMG c is at (c%2, c/2), and the diagonal pairs of A64FX, (0,3) and
+    (1,2), are 2 steps apart.
+    If a node has less processes than CMG_NUM, a process takes
+    CMG_NUM/ppn CMGs.
+    The rankmap file does not change: the binding file gives the CPUs
+    and the memory of each rankid, to be applied by the job script.
+
+**************************************************/
+typedef struct {
+  int ppn;
+  int grid[4];              // CMG blocks of the intra-node process lattice
+  int block[CMG_NUM];       // block[cmg]: lexical index of the block in grid
+  int ranks_per_cmg;        // 0 if a process takes more than one CMG
+  int cmgs_per_rank;        // 0 if a node has CMG_NUM processes or more
+  int *cmg;                 // cmg[intra]: the (first) CMG of the intra-node index
+  int *slot;                // slot[intra]: the order in the CMG
+  double cost;              // halo bytes between the CMGs x distance, per node
+  double cost_default;      // the same for the CMGs in the rankid order in each node
+  const char *unit;
+} cmg_map;
+
+// returns 0, or -1 if the processes per node do not fit the CMGs
+//   or the map is made by the fallback mapper
+int  set_cmg_map(cmg_map *map, const proc_dim *dim);
+void print_cmg_map(FILE *fp, const cmg_map *map, const proc_dim *dim);
+
+// one line for each rankid: "rankid cmg cpus mems", e.g. "5 1 24-35 5"
+//   returns 0, or -1 if the file cannot be written
+int  write_binding(const char *file, const cmg_map *map, const proc_dim *dim);
+void free_cmg_map(cmg_map *map);
+
+#endif
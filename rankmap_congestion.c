@@ -0,0 +1,247 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "rankmap_congestion.h"
+
+// defined in calc_rankid.c
+int calc_rankid(const int *coords, const int *psize);
+void get_rank_coord(int *coords, int rank, const int *psize);
+
+
+/********************************************************
+ * links on the route from src to dst
+ *   dimension-order routing: x, y, then z
+ *   on a torus axis, the shorter way (forward for a tie)
+ *   returns the number of the links (= hop)
+ ********************************************************/
+static int route_links(long *links, const int *src, const int *dst,
+                       const int *shape, const int *periodic){
+  int n=0;
+  int c[3]={src[0], src[1], src[2]};
+  for(int axis=0; axis<3; axis++){
+    int d=dst[axis]-c[axis];
+    if(periodic[axis]){
+      if(2*d > shape[axis]){ d-=shape[axis]; }
+      if(2*d <= -shape[axis]){ d+=shape[axis]; }
+    }
+    int step = (d>0) ? 1 : -1;
+    int back = (d>0) ? 0 : 1;
+    for(; d!=0; d-=step){
+      long node = c[0] + (long)shape[0]*(c[1] + (long)shape[1]*c[2]);
+      links[n++] = LINK_NDIR*node + 2*axis + back;
+      c[axis] = (c[axis]+step+shape[axis]) % shape[axis];
+    }
+  }
+  return n;
+}
+
+
+// rank of the neighbor in the direction dir
+static int neighbor_rank(int *coords, const int *psize, const int dir){
+  int mu=dir/2;
+  int c=coords[mu];
+  coords[mu] = (dir%2==0) ? (c+1)%psize[mu] : (c-1+psize[mu])%psize[mu];
+  int neighbor=calc_rankid(coords, psize);
+  coords[mu]=c;
+  return neighbor;
+}
+
+
+const char *halo_message_bytes(double *msg_bytes, const int *psize, const int *lattice, const int site_bytes){
+  for(int dir=0; dir<HALO_NDIR; dir++){
+    msg_bytes[dir]=1.0;
+  }
+  if(lattice[0]<=0){
+    return "messages";
+  }
+  for(int dir=0; dir<HALO_NDIR; dir++){
+    int mu=dir/2;
+    msg_bytes[dir]=site_bytes;
+    for(int nu=0; nu<4; nu++){
+      if(nu != mu){
+        msg_bytes[dir] *= lattice[nu]/psize[nu];
+      }
+    }
+  }
+  return "bytes";
+}
+
+
+/********************************************************
+ * load of all the links
+ *   rank_list[3*rankid + i]: 3-dim node coordinate of rankid
+ *   the loop over the source ranks runs with OpenMP, if enabled
+ ********************************************************/
+void simulate_links(link_load *ll, const int *rank_list, const int *psize, const int *shape,
+                    const int *periodic, const double *msg_bytes){
+  int np=psize[0]*psize[1]*psize[2]*psize[3];
+  int max_route=0;
+  ll->np=np;
+  for(int mu=0; mu<4; mu++){
+    ll->psize[mu]=psize[mu];
+  }
+  for(int i=0; i<3; i++){
+    ll->shape[i]=shape[i];
+    ll->periodic[i]=periodic[i];
+    max_route+=shape[i];
+  }
+  ll->num_links=LINK_NDIR*(long)shape[0]*shape[1]*shape[2];
+  ll->load=calloc(ll->num_links, sizeof(double));
+
+  // accumulate the load
+#pragma omp parallel
+  {
+    long *links=malloc(sizeof(long)*max_route);
+#pragma omp for schedule(static)
+    for(int rank=0; rank<np; rank++){
+      int coords[4];
+      get_rank_coord(coords, rank, psize);
+      for(int dir=0; dir<HALO_NDIR; dir++){
+        int neighbor=neighbor_rank(coords, psize, dir);
+        int n=route_links(links, rank_list+3*rank, rank_list+3*neighbor, shape, periodic);
+        for(int k=0; k<n; k++){
+#pragma omp atomic
+          ll->load[links[k]]+=msg_bytes[dir];
+        }
+      }
+    }
+    free(links);
+  }
+
+  // summary
+  ll->max_load=0.0;
+  ll->max_link=-1;
+  ll->num_max_links=0;
+  ll->used_links=0;
+  ll->sum_load=0.0;
+  for(int i=0; i<LINK_NDIR; i++){
+    ll->axis_max[i]=0.0;
+  }
+  for(long link=0; link<ll->num_links; link++){
+    double load=ll->load[link];
+    if(load>0.0){ ll->used_links++; }
+    ll->sum_load+=load;
+    if(load > ll->axis_max[link%LINK_NDIR]){
+      ll->axis_max[link%LINK_NDIR]=load;
+    }
+    if(load > ll->max_load){
+      ll->max_load=load;
+      ll->max_link=link;
+      ll->num_max_links=0;
+    }
+    if(load == ll->max_load && load>0.0){
+      ll->num_max_links++;
+    }
+  }
+
+  // the directions which contribute to the max loaded links
+  for(int dir=0; dir<HALO_NDIR; dir++){
+    ll->max_by_dir[dir]=0.0;
+  }
+  if(ll->max_load<=0.0){
+    return;
+  }
+#pragma omp parallel
+  {
+    long *links=malloc(sizeof(long)*max_route);
+    double by_dir[HALO_NDIR]={0.0};
+#pragma omp for schedule(static)
+    for(int rank=0; rank<np; rank++){
+      int coords[4];
+      get_rank_coord(coords, rank, psize);
+      for(int dir=0; dir<HALO_NDIR; dir++){
+        int neighbor=neighbor_rank(coords, psize, dir);
+        int n=route_links(links, rank_list+3*rank, rank_list+3*neighbor, shape, periodic);
+        for(int k=0; k<n; k++){
+          if(ll->load[links[k]] == ll->max_load){
+            by_dir[dir]+=msg_bytes[dir];
+          }
+        }
+      }
+    }
+    for(int dir=0; dir<HALO_NDIR; dir++){
+#pragma omp atomic
+      ll->max_by_dir[dir]+=by_dir[dir];
+    }
+    free(links);
+  }
+}
+
+
+void print_link_load(FILE *fp, const link_load *ll, const char *unit){
+  const char sign[2]={'+','-'};
+  const char axis[3]={'x','y','z'};
+  const int nbin=10;
+
+  fprintf(fp, "link load: %dx%dx%dx%d processes on %dx%dx%d nodes (periodic: %d%d%d), dimension-order routing\n",
+          ll->psize[0], ll->psize[1], ll->psize[2], ll->psize[3],
+          ll->shape[0], ll->shape[1], ll->shape[2],
+          ll->periodic[0], ll->periodic[1], ll->periodic[2]);
+  fprintf(fp, "  links: %ld, used: %ld\n", ll->num_links, ll->used_links);
+  fprintf(fp, "  max load: %.6g %s (%ld links)\n", ll->max_load, unit, ll->num_max_links);
+  if(ll->used_links>0){
+    fprintf(fp, "  mean load: %.6g %s (used links), %.6g %s (all links)\n",
+            ll->sum_load/ll->used_links, unit, ll->sum_load/ll->num_links, unit);
+  }
+  fprintf(fp, "  max load for each link direction\n");
+  for(int i=0; i<LINK_NDIR; i++){
+    fprintf(fp, "    %c%c  %.6g\n", sign[i%2], axis[i/2], ll->axis_max[i]);
+  }
+  if(ll->max_link<0){
+    return;
+  }
+
+  long node=ll->max_link/LINK_NDIR;
+  int c[3];
+  c[0]=node % ll->shape[0];
+  c[1]=(node / ll->shape[0]) % ll->shape[1];
+  c[2]=node / ((long)ll->shape[0]*ll->shape[1]);
+  int l=ll->max_link%LINK_NDIR;
+  fprintf(fp, "  max loaded link: (%d,%d,%d) %c%c, and the others with the same load\n",
+          c[0], c[1], c[2], sign[l%2], axis[l/2]);
+  fprintf(fp, "  contribution to the max loaded links\n");
+  double total=ll->max_load*ll->num_max_links;
+  for(int dir=0; dir<HALO_NDIR; dir++){
+    fprintf(fp, "    %c%d  %6.2f%%\n", sign[dir%2], dir/2+1, 100.0*ll->max_by_dir[dir]/total);
+  }
+
+  // distribution of the used links
+  long hist[10]={0};
+  for(long link=0; link<ll->num_links; link++){
+    double load=ll->load[link];
+    if(load<=0.0){ continue; }
+    int bin=(int)(nbin*load/ll->max_load);
+    if(bin>=nbin){ bin=nbin-1; }
+    hist[bin]++;
+  }
+  fprintf(fp, "  distribution of the load (used links)\n");
+  for(int bin=0; bin<nbin; bin++){
+    fprintf(fp, "    %3d%% - %3d%%  %10ld\n", 100*bin/nbin, 100*(bin+1)/nbin, hist[bin]);
+  }
+}
+
+
+void free_link_load(link_load *ll){
+  free(ll->load);
+  ll->load=NULL;
+}
@@ -0,0 +1,66 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+ */
+#ifndef rankmap_4d_congestion_h
+#define rankmap_4d_congestion_h
+
+#include <stdio.h>
+#include "rankmap_analyze.h"
+
+/**************************************************
+
+  link load of the nearest neighbor halo exchange
+    every message is routed on the 3-dim node lattice with
+    the dimension-order routing (x, y, then z; the shorter way
+    on a torus axis), and the bytes are accumulated on each link
+
+    link index: 6*node + 2*axis + (0: forward, 1: backward)
+      node = x + PP1*(y + PP2*z)
+
+**************************************************/
+#define LINK_NDIR 6
+
+typedef struct {
+  int    np;
+  int    psize[4];
+  int    shape[3];
+  int    periodic[3];
+  long   num_links;
+  double *load;                   // load[link]
+  double max_load;
+  long   max_link;                // the first link with the max load
+  long   num_max_links;           // number of the links with the max load
+  long   used_links;              // number of the links with non-zero load
+  double sum_load;
+  double axis_max[LINK_NDIR];     // max load for each link direction
+  double max_by_dir[HALO_NDIR];   // bytes on the max loaded links from each direction
+} link_load;
+
+// msg_bytes[dir]: bytes of a message in each direction (HALO_NDIR)
+//   1 for each message, if the lattice is not given (lattice[0]=0)
+//   returns the unit for print_link_load()
+const char *halo_message_bytes(double *msg_bytes, const int *psize, const int *lattice, const int site_bytes);
+void simulate_links(link_load *ll, const int *rank_list, const int *psize, const int *shape,
+                    const int *periodic, const double *msg_bytes);
+void print_link_load(FILE *fp, const link_load *ll, const char *unit);
+void free_link_load(link_load *ll);
+
+#endif
@@ -0,0 +1,342 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "rankmap_analyze.h"
+#include "rankmap_ensemble.h"
+
+
+// proc_dim of a member, as get_param()
+static int set_member_dim(proc_dim *dim, const int *psize, const int *intra_psize, const int ppn){
+  dim->ppn=ppn;
+  dim->fold.type=FOLD_NONE;
+  dim->physical=0;
+  dim->fallback_time=0.0;
+  dim->fallback=0;
+  dim->notofu_dir=-1;
+  dim->site_bytes=0;
+  int n=1;
+  for(int i=0; i<4; i++){
+    dim->psize[i]=psize[i];
+    dim->intra_psize[i]=intra_psize[i];
+    dim->lattice[i]=0;
+    if(psize[i]<1 || intra_psize[i]<1 || psize[i] % intra_psize[i] != 0){ return -1; }
+    if(psize[i]==intra_psize[i]){
+      dim->notofu_dir=i;
+    }
+    n*=intra_psize[i];
+  }
+  for(int i=0; i<3; i++){
+    dim->periodic[i]=1;
+  }
+  return (n==ppn) ? 0 : -1;
+}
+
+
+int read_ensemble(ensemble *ens, const char *file, const int ppn){
+  ens->num=0;
+  ens->np=0;
+  ens->member=NULL;
+  FILE *fp=fopen(file, "r");
+  if(!fp){
+    return -1;
+  }
+  int size=0;
+  int line=0;
+  char buf[1024];
+  while(fgets(buf, sizeof(buf), fp)){
+    line++;
+    char *c=strchr(buf, '#');
+    if(c){ *c='\0'; }
+    int p[4], q[4];
+    int count=1;
+    int n=sscanf(buf, "%d %d %d %d %d %d %d %d %d", p, p+1, p+2, p+3, q, q+1, q+2, q+3, &count);
+    if(n<=0){ continue; }  // blank line
+    if(n<8 || count<1){
+      fclose(fp);
+      return line;
+    }
+    for(int k=0; k<count; k++){
+      if(ens->num==size){
+        size = (size==0) ? 16 : 2*size;
+        ens->member=realloc(ens->member, sizeof(ensemble_member)*size);
+      }
+      ensemble_member *m=&ens->member[ens->num];
+      if(set_member_dim(&m->dim, p, q, ppn)){
+        fclose(fp);
+        return line;
+      }
+      m->first_rank=ens->np;
+      m->np=p[0]*p[1]*p[2]*p[3];
+      ens->np += m->np;
+      ens->num++;
+    }
+  }
+  fclose(fp);
+  return (ens->num>0) ? 0 : line+1;
+}
+
+
+/********************************************************
+ * packing of the member boxes
+ *   the free space is a list of boxes; a member takes the
+ *   corner of a free box, and the rest of the free box is cut
+ *   into 3 boxes (guillotine).  For each member, the box shape
+ *   and the free box are chosen by, in this order,
+ *     the smallest free box (best fit),
+ *     the most axes of the same size as the free box,
+ *     no folding of the 4-dim directions,
+ *     the smallest surface of the box
+ ********************************************************/
+typedef struct {
+  int origin[3];
+  int size[3];
+} free_box;
+
+static long box_volume(const int *size){
+  return (long)size[0]*size[1]*size[2];
+}
+
+int pack_ensemble(ensemble *ens, const int *shape, const int *periodic){
+  // larger members first, the file order for the same size
+  int *order=malloc(sizeof(int)*ens->num);
+  for(int i=0; i<ens->num; i++){
+    int j=i;
+    while(j>0 && ens->member[order[j-1]].np < ens->member[i].np){
+      order[j]=order[j-1];
+      j--;
+    }
+    order[j]=i;
+  }
+
+  // at most 2 more free boxes for each member
+  free_box *space=malloc(sizeof(free_box)*(2*ens->num+1));
+  int num_space=1;
+  for(int i=0; i<3; i++){
+    space[0].origin[i]=0;
+    space[0].size[i]=shape[i];
+  }
+
+  int bad=0;
+  for(int k=0; k<ens->num && !bad; k++){
+    ensemble_member *m=&ens->member[order[k]];
+    const int nodes=m->np/m->dim.ppn;
+    int best=-1;
+    long best_score[4]={0,0,0,0};
+    int box[3];
+    for(box[0]=1; box[0]<=shape[0]; box[0]++){
+      for(box[1]=1; box[1]<=shape[1]; box[1]++){
+        if(nodes % (box[0]*box[1]) != 0){ continue; }
+        box[2]=nodes/(box[0]*box[1]);
+        if(box[2]>shape[2]){ continue; }
+        for(int s=0; s<num_space; s++){
+          const int *fs=space[s].size;
+          if(box[0]>fs[0] || box[1]>fs[1] || box[2]>fs[2]){ continue; }
+          int dirmap[4];
+          proc_dim dim=m->dim;
+          if(!find_direction_map(dirmap, &dim, box)){ continue; }
+          long score[4];
+          score[0]=box_volume(fs);
+          score[1]=-((box[0]==fs[0]) + (box[1]==fs[1]) + (box[2]==fs[2]));
+          score[2]=(dim.fold.type != FOLD_NONE);
+          score[3]=(long)box[0]*box[1] + (long)box[1]*box[2] + (long)box[2]*box[0];
+          int better=(best<0);
+          for(int l=0; l<4 && !better; l++){
+            if(score[l] != best_score[l]){
+              better = (score[l] < best_score[l]);
+              break;
+            }
+          }
+          if(!better){ continue; }
+          best=s;
+          for(int l=0; l<4; l++){
+            best_score[l]=score[l];
+          }
+          for(int i=0; i<3; i++){
+            m->box[i]=box[i];
+          }
+        }
+      }
+    }
+    if(best<0){
+      bad=order[k]+1;
+      break;
+    }
+
+    // take the corner of the free box, and cut the rest
+    free_box fb=space[best];
+    space[best]=space[--num_space];
+    for(int i=0; i<3; i++){
+      m->origin[i]=fb.origin[i];
+    }
+    for(int a=0; a<3; a++){
+      if(fb.size[a]==m->box[a]){ continue; }
+      free_box *r=&space[num_space++];
+      for(int i=0; i<3; i++){
+        // the axes before a: the extent of the member, after a: the free box
+        r->origin[i]=fb.origin[i];
+        r->size[i] = (i<a) ? m->box[i] : fb.size[i];
+      }
+      r->origin[a]=fb.origin[a]+m->box[a];
+      r->size[a]=fb.size[a]-m->box[a];
+    }
+
+    // the axes of the box are periodic only if it spans the whole axis
+    for(int i=0; i<3; i++){
+      m->dim.periodic[i] = (m->box[i]==shape[i]) ? periodic[i] : 0;
+    }
+    find_direction_map(m->dirmap, &m->dim, m->box);
+  }
+  free(space);
+  free(order);
+  return bad;
+}
+
+
+int ensemble_rank_list(int *rank_list, const ensemble *ens, const int *node_list, const int n,
+                       const int *shape){
+  const int num_nodes=shape[0]*shape[1]*shape[2];
+  int *owner=malloc(sizeof(int)*num_nodes);
+  int *node_count=calloc(num_nodes, sizeof(int));
+  for(int node=0; node<num_nodes; node++){
+    owner[node]=-1;
+  }
+  for(int k=0; k<ens->num; k++){
+    const ensemble_member *m=&ens->member[k];
+    int c[3];
+    for(c[2]=m->origin[2]; c[2]<m->origin[2]+m->box[2]; c[2]++){
+      for(c[1]=m->origin[1]; c[1]<m->origin[1]+m->box[1]; c[1]++){
+        for(c[0]=m->origin[0]; c[0]<m->origin[0]+m->box[0]; c[0]++){
+          owner[node_index(c, shape)]=k;
+        }
+      }
+    }
+  }
+
+  for(int i=0; i<3*ens->np; i++){
+    rank_list[i]=-1;
+  }
+  for(int rank=0; rank<n; rank++){
+    const int *coords_fjmpi=node_list+3*rank;
+    int node=node_index(coords_fjmpi, shape);
+    if(node<0 || owner[node]<0){ continue; }
+    const ensemble_member *m=&ens->member[owner[node]];
+    int intra_rank=node_count[node]++;
+    if(intra_rank >= m->dim.ppn){ continue; }
+
+    int local[4]={0,0,0,0};
+    for(int i=0; i<3; i++){
+      local[i]=coords_fjmpi[i]-m->origin[i];
+    }
+    int coords[4];
+    calc_proc_coords(coords, local, intra_rank, m->dirmap, &m->dim);
+    int rankid=calc_rankid(coords, m->dim.psize);
+    if(rankid < 0 || rankid >= m->np){ continue; }
+    for(int i=0; i<3; i++){
+      rank_list[3*(m->first_rank+rankid)+i]=coords_fjmpi[i];
+    }
+  }
+  free(node_count);
+  free(owner);
+
+  int missing=0;
+  for(int rank=0; rank<ens->np; rank++){
+    missing += (rank_list[3*rank]<0);
+  }
+  return missing;
+}
+
+
+void print_ensemble(FILE *fp, const ensemble *ens, const int *shape){
+  long nodes=0;
+  for(int k=0; k<ens->num; k++){
+    nodes += box_volume(ens->member[k].box);
+  }
+  fprintf(fp, "ensemble: %d members, %d processes on %ld of %ld nodes\n",
+          ens->num, ens->np, nodes, box_volume(shape));
+  fprintf(fp, "  member  first rank  process lattice  intra-node  node box  origin    periodic\n");
+  for(int k=0; k<ens->num; k++){
+    const ensemble_member *m=&ens->member[k];
+    const int *p=m->dim.psize;
+    const int *q=m->dim.intra_psize;
+    char plat[64], qlat[64], box[64], org[64];
+    snprintf(plat, sizeof(plat), "%dx%dx%dx%d", p[0], p[1], p[2], p[3]);
+    snprintf(qlat, sizeof(qlat), "%dx%dx%dx%d", q[0], q[1], q[2], q[3]);
+    snprintf(box, sizeof(box), "%dx%dx%d", m->box[0], m->box[1], m->box[2]);
+    snprintf(org, sizeof(org), "%d,%d,%d", m->origin[0], m->origin[1], m->origin[2]);
+    fprintf(fp, "  %6d  %10d  %-15s  %-10s  %-8s  %-8s  %d%d%d\n",
+            k, m->first_rank, plat, qlat, box, org,
+            m->dim.periodic[0], m->dim.periodic[1], m->dim.periodic[2]);
+  }
+}
+
+
+void print_ensemble_halo(FILE *fp, const ensemble *ens, const int *rank_list, const int *shape,
+                         const int *periodic){
+  fprintf(fp, "halo hop distance of the members (on the %dx%dx%d nodes, periodic: %d%d%d)\n",
+          shape[0], shape[1], shape[2], periodic[0], periodic[1], periodic[2]);
+  fprintf(fp, "  member   max     mean  inter-node\n");
+  for(int k=0; k<ens->num; k++){
+    const ensemble_member *m=&ens->member[k];
+    halo_stat stat;
+    analyze_halo(&stat, rank_list+3*m->first_rank, m->dim.psize, shape, periodic);
+    int max_hop=0;
+    double sum_hop=0.0;
+    double intra=0.0;
+    for(int dir=0; dir<HALO_NDIR; dir++){
+      if(stat.max_hop[dir]>max_hop){
+        max_hop=stat.max_hop[dir];
+      }
+      sum_hop += stat.sum_hop[dir];
+      intra += stat.intra_count[dir];
+    }
+    double msgs=(double)HALO_NDIR*m->np;
+    fprintf(fp, "  %6d  %4d  %7.3f     %6.2f%%\n", k, max_hop, sum_hop/msgs, 100.0*(msgs-intra)/msgs);
+    free_halo_stat(&stat);
+  }
+}
+
+
+int write_ensemble_table(const char *file, const ensemble *ens){
+  FILE *fp=fopen(file, "w");
+  if(!fp){
+    return -1;
+  }
+  fprintf(fp, "# member first_rank np P1 P2 P3 P4 p1 p2 p3 p4 origin_x origin_y origin_z box_x box_y box_z\n");
+  for(int k=0; k<ens->num; k++){
+    const ensemble_member *m=&ens->member[k];
+    const int *p=m->dim.psize;
+    const int *q=m->dim.intra_psize;
+    fprintf(fp, "%d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d\n",
+            k, m->first_rank, m->np, p[0], p[1], p[2], p[3], q[0], q[1], q[2], q[3],
+            m->origin[0], m->origin[1], m->origin[2], m->box[0], m->box[1], m->box[2]);
+  }
+  return fclose(fp)==0 ? 0 : -1;
+}
+
+
+void free_ensemble(ensemble *ens){
+  free(ens->member);
+  ens->member=NULL;
+  ens->num=0;
+}
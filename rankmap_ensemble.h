@@ -0,0 +1,89 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+ */
+#ifndef rankmap_4d_ensemble_h
+#define rankmap_4d_ensemble_h
+
+#include <stdio.h>
+#include "rankmap_4d_core.h"
+
+/**************************************************
+
+  ensemble of independent 4-dim process lattices in one allocation
+    each member has its own process lattice and intra-node lattice,
+    and a disjoint box of the 3-dim node lattice; the box is mapped
+    as the whole allocation (set_direction_map), with the axes of the
+    box non-periodic unless the box spans the axis.
+    The members take the ranks in the order of the ensemble file,
+    and the ranks of a member are in the order of its rankid:
+      rank = first_rank + calc_rankid(coords, psize)
+
+  ensemble file: one line for each member (or count members)
+      P1 P2 P3 P4 p1 p2 p3 p4 [count]
+    '#' starts a comment
+
+**************************************************/
+typedef struct {
+  int first_rank;
+  int np;
+  int box[3];       // node box: box[i] nodes from origin[i]
+  int origin[3];
+  int dirmap[4];
+  proc_dim dim;     // psize, intra_psize, fold and the periodicity in the box
+} ensemble_member;
+
+typedef struct {
+  int num;
+  int np;           // processes of all the members
+  ensemble_member *member;
+} ensemble;
+
+// returns 0, the line number of a bad line, or -1 if the file cannot be read
+int  read_ensemble(ensemble *ens, const char *file, const int ppn);
+
+// boxes of the members in the node shape, larger members first (guillotine cut)
+//   returns 0, or 1 + the member which does not fit
+int  pack_ensemble(ensemble *ens, const int *shape, const int *periodic);
+
+// rank_list[3*rank]: the node coordinate of each rank of the ensemble (ens->np)
+//   from node_list[3*i] of the n processes of the allocation
+//   returns the number of the ranks without a node (0 if success)
+int  ensemble_rank_list(int *rank_list, const ensemble *ens, const int *node_list, const int n,
+                        const int *shape);
+
+void print_ensemble(FILE *fp, const ensemble *ens, const int *shape);
+
+// hop distance of the halo exchange in each member
+void print_ensemble_halo(FILE *fp, const ensemble *ens, const int *rank_list, const int *shape,
+                         const int *periodic);
+
+// one line for each member, for MPI_Comm_split() in the application
+//   returns 0, or -1 if the file cannot be written
+int  write_ensemble_table(const char *file, const ensemble *ens);
+
+void free_ensemble(ensemble *ens);
+
+// defined in rankmap_4d_mpi.c (MPI programs only)
+//   periodic[3]: given (-1: not given), and the one of the topology on return
+//   rank_list[3*ens->np] is set on rank 0
+void set_ensemble_rankmap(int *rank_list, int *shape_fjmpi, int *periodic, ensemble *ens);
+
+#endif
@@ -0,0 +1,332 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+    2026 Oct. 17 the temperature from the number of the moves, not from the time
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "rankmap_analyze.h"
+#include "rankmap_congestion.h"
+#include "rankmap_profile.h"
+#include "rankmap_fallback.h"
+
+// moves of the refinement for each process, if the time budget is not reached
+#define FALLBACK_MOVES_PER_PROC 100
+
+
+/********************************************************
+ * random numbers: xorshift64*, the same sequence everywhere
+ ********************************************************/
+static unsigned long long rand_state;
+
+static unsigned long long rand_next(void){
+  rand_state ^= rand_state >> 12;
+  rand_state ^= rand_state << 25;
+  rand_state ^= rand_state >> 27;
+  return rand_state * 2685821657736338717ULL;
+}
+
+static int rand_int(const int n){
+  return (int)(rand_next() % (unsigned long long)n);
+}
+
+static double rand_uniform(void){
+  return (rand_next() >> 11) * (1.0/9007199254740992.0);
+}
+
+// exp(-x) for x>=0 as (1-x/256)^256, enough for the acceptance (no libm)
+static double exp_neg(const double x){
+  double y=1.0-x/256.0;
+  if(y<=0.0){ return 0.0; }
+  for(int i=0; i<8; i++){
+    y*=y;
+  }
+  return y;
+}
+
+
+typedef struct {
+  int    np;
+  int    psize[4];
+  int    stride[4];
+  int    shape[3];
+  int    periodic[3];
+  double weight[4];     // bytes of the messages of a neighbor pair (both ways)
+  int    *slot_coords;  // slot_coords[3*slot]: the node of the slot
+  int    *slot_first;   // first slot of the same node
+  int    *slot_count;   // number of the slots of the same node
+  int    *proc_slot;    // proc_slot[p]: the slot of the process (lexical index)
+  int    *slot_proc;
+} fallback_state;
+
+
+static int hop(const int *a, const int *b, const int *shape, const int *periodic){
+  int h=0;
+  for(int i=0; i<3; i++){
+    int d=abs(a[i]-b[i]);
+    if(periodic[i] && 2*d>shape[i]){
+      d=shape[i]-d;
+    }
+    h+=d;
+  }
+  return h;
+}
+
+// neighbor of the process p in the direction mu (sign: +1 or -1), periodic
+static int neighbor(const fallback_state *st, const int p, const int mu, const int sign){
+  int c=(p/st->stride[mu]) % st->psize[mu];
+  int n=(c+sign+st->psize[mu]) % st->psize[mu];
+  return p + (n-c)*st->stride[mu];
+}
+
+// bytes x hops of the messages between p and its neighbors
+static double local_cost(const fallback_state *st, const int p){
+  const int *a=st->slot_coords+3*st->proc_slot[p];
+  double cost=0.0;
+  for(int mu=0; mu<4; mu++){
+    for(int sign=-1; sign<=1; sign+=2){
+      const int *b=st->slot_coords+3*st->proc_slot[neighbor(st, p, mu, sign)];
+      cost += st->weight[mu]*hop(a, b, st->shape, st->periodic);
+    }
+  }
+  return cost;
+}
+
+static double total_cost(const fallback_state *st){
+  double cost=0.0;
+  for(int p=0; p<st->np; p++){
+    cost+=local_cost(st, p);
+  }
+  return 0.5*cost;
+}
+
+
+/********************************************************
+ * recursive bisection
+ *   the processes in the box lo[] + ext[] of the process
+ *   lattice are assigned to the slots keys[0..n-1]
+ ********************************************************/
+typedef struct {
+  long key;
+  int  slot;
+} slot_key;
+
+static int compare_key(const void *a, const void *b){
+  const slot_key *ka=a;
+  const slot_key *kb=b;
+  if(ka->key != kb->key){
+    return (ka->key < kb->key) ? -1 : 1;
+  }
+  return ka->slot - kb->slot;
+}
+
+static void bisect(fallback_state *st, slot_key *keys, const int n, const int *lo, const int *ext){
+  if(n==1){
+    int p=0;
+    for(int mu=0; mu<4; mu++){
+      p += lo[mu]*st->stride[mu];
+    }
+    st->proc_slot[p]=keys[0].slot;
+    return;
+  }
+
+  // the longest direction of the processes
+  int d=0;
+  for(int mu=1; mu<4; mu++){
+    if(ext[mu]>ext[d]){ d=mu; }
+  }
+  // the longest axis of the nodes; the slots of a node stay together
+  int cmin[3], cmax[3];
+  for(int i=0; i<3; i++){
+    cmin[i]=st->shape[i];
+    cmax[i]=-1;
+  }
+  for(int k=0; k<n; k++){
+    const int *c=st->slot_coords+3*keys[k].slot;
+    for(int i=0; i<3; i++){
+      if(c[i]<cmin[i]){ cmin[i]=c[i]; }
+      if(c[i]>cmax[i]){ cmax[i]=c[i]; }
+    }
+  }
+  int a=0;
+  for(int i=1; i<3; i++){
+    if(cmax[i]-cmin[i] > cmax[a]-cmin[a]){ a=i; }
+  }
+  const long num_nodes=(long)st->shape[0]*st->shape[1]*st->shape[2];
+  for(int k=0; k<n; k++){
+    const int *c=st->slot_coords+3*keys[k].slot;
+    keys[k].key = c[a]*num_nodes + c[0] + (long)st->shape[0]*(c[1] + (long)st->shape[1]*c[2]);
+  }
+  qsort(keys, n, sizeof(slot_key), compare_key);
+
+  int half=ext[d]/2;
+  int k=n/ext[d]*half;
+  int lo2[4], ext1[4], ext2[4];
+  for(int mu=0; mu<4; mu++){
+    lo2[mu]=lo[mu];
+    ext1[mu]=ext[mu];
+    ext2[mu]=ext[mu];
+  }
+  ext1[d]=half;
+  lo2[d]=lo[d]+half;
+  ext2[d]=ext[d]-half;
+  bisect(st, keys, k, lo, ext1);
+  bisect(st, keys+k, n-k, lo2, ext2);
+}
+
+
+/********************************************************
+ * refinement by simulated annealing
+ *   a move swaps the process p with one on the node of a
+ *   random neighbor of p; the temperature goes down linearly
+ *   with the number of the moves, from the weight of one neighbor
+ *   pair to 0.  The time budget only stops the moves, so that the
+ *   schedule does not depend on the speed of the machine.
+ ********************************************************/
+static void anneal(fallback_state *st, fallback_stat *stat, const double budget_sec){
+  double t_init=0.0;
+  for(int mu=0; mu<4; mu++){
+    if(st->weight[mu]>t_init){ t_init=st->weight[mu]; }
+  }
+  const long max_moves=(long)FALLBACK_MOVES_PER_PROC*st->np;
+  const double start=profile_wtime();
+  double temp=t_init;
+  for(long m=0; m<max_moves; m++){
+    if(m%1024==0){
+      if(profile_wtime()-start >= budget_sec){ break; }
+      temp=t_init*(1.0-(double)m/max_moves);
+    }
+    stat->moves++;
+    int p=rand_int(st->np);
+    int r=neighbor(st, p, rand_int(4), rand_int(2) ? 1 : -1);
+    int sr=st->proc_slot[r];
+    int sq=st->slot_first[sr] + rand_int(st->slot_count[sr]);
+    int sp=st->proc_slot[p];
+    if(st->slot_first[sq]==st->slot_first[sp]){ continue; }  // the same node
+    int q=st->slot_proc[sq];
+
+    double before=local_cost(st, p)+local_cost(st, q);
+    st->proc_slot[p]=sq;
+    st->proc_slot[q]=sp;
+    double delta=local_cost(st, p)+local_cost(st, q)-before;
+    if(delta<=0.0 || (temp>0.0 && rand_uniform() < exp_neg(delta/temp))){
+      st->slot_proc[sq]=p;
+      st->slot_proc[sp]=q;
+      stat->accepted++;
+    } else {
+      st->proc_slot[p]=sp;
+      st->proc_slot[q]=sq;
+    }
+  }
+}
+
+
+int fallback_map(int *rank_list, fallback_stat *stat, const int *node_list, const int *shape,
+                 const int *periodic, const proc_dim *dim, const double budget_sec){
+  const double start=profile_wtime();
+  fallback_state st;
+  st.np=np;
+  int stride=1;
+  for(int mu=0; mu<4; mu++){
+    st.psize[mu]=dim->psize[mu];
+    st.stride[mu]=stride;
+    stride*=dim->psize[mu];
+  }
+  for(int i=0; i<3; i++){
+    st.shape[i]=shape[i];
+    st.periodic[i]=periodic[i];
+  }
+  double msg_bytes[HALO_NDIR];
+  stat->unit=halo_message_bytes(msg_bytes, dim->psize, dim->lattice, dim->site_bytes);
+  for(int mu=0; mu<4; mu++){
+    st.weight[mu]=msg_bytes[2*mu]+msg_bytes[2*mu+1];
+  }
+
+  // slots: the processes of the allocation, sorted by the node
+  slot_key *keys=malloc(sizeof(slot_key)*np);
+  for(int rank=0; rank<np; rank++){
+    keys[rank].key=node_index(node_list+3*rank, shape);
+    keys[rank].slot=rank;
+    if(keys[rank].key<0){
+      free(keys);
+      return -1;
+    }
+  }
+  qsort(keys, np, sizeof(slot_key), compare_key);
+  st.slot_coords=malloc(sizeof(int)*3*np);
+  st.slot_first=malloc(sizeof(int)*np);
+  st.slot_count=malloc(sizeof(int)*np);
+  st.proc_slot=malloc(sizeof(int)*np);
+  st.slot_proc=malloc(sizeof(int)*np);
+  for(int s=0; s<np; s++){
+    for(int i=0; i<3; i++){
+      st.slot_coords[3*s+i]=node_list[3*keys[s].slot+i];
+    }
+    st.slot_first[s] = (s>0 && keys[s].key==keys[s-1].key) ? st.slot_first[s-1] : s;
+    st.slot_count[st.slot_first[s]] = s-st.slot_first[s]+1;
+  }
+  for(int s=0; s<np; s++){
+    st.slot_count[s]=st.slot_count[st.slot_first[s]];
+    keys[s].slot=s;
+  }
+
+  // recursive bisection
+  int lo[4]={0,0,0,0};
+  bisect(&st, keys, np, lo, dim->psize);
+  free(keys);
+  for(int p=0; p<np; p++){
+    st.slot_proc[st.proc_slot[p]]=p;
+  }
+  stat->cost_bisection=total_cost(&st);
+
+  // refinement in the rest of the time budget
+  rand_state=88172645463325252ULL;
+  stat->moves=0;
+  stat->accepted=0;
+  double rest=budget_sec-(profile_wtime()-start);
+  if(rest>0.0){
+    anneal(&st, stat, rest);
+  }
+  stat->cost=total_cost(&st);
+
+  for(int p=0; p<np; p++){
+    int c[4];
+    for(int mu=0; mu<4; mu++){
+      c[mu]=(p/st.stride[mu]) % st.psize[mu];
+    }
+    int rankid=calc_rankid(c, dim->psize);
+    for(int i=0; i<3; i++){
+      rank_list[3*rankid+i]=st.slot_coords[3*st.proc_slot[p]+i];
+    }
+  }
+  free(st.slot_coords);
+  free(st.slot_first);
+  free(st.slot_count);
+  free(st.proc_slot);
+  free(st.slot_proc);
+  stat->time_sec=profile_wtime()-start;
+  return 0;
+}
+
+
+void print_fallback_stat(FILE *fp, const fallback_stat *stat){
+  fprintf(fp, "fallback map: halo %s x hops %.6g by the recursive bisection, %.6g after %ld moves (%ld accepted), %.2f sec\n",
+          stat->unit, stat->cost_bisection, stat->cost, stat->moves, stat->accepted, stat->time_sec);
+}
@@ -0,0 +1,63 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+    2026 Oct. 17 the temperature from the number of the moves, not from the time
+ */
+#ifndef rankmap_4d_fallback_h
+#define rankmap_4d_fallback_h
+
+#include <stdio.h>
+#include "rankmap_4d_core.h"
+
+/**************************************************
+
+  fallback mapper, for the allocations which do not match the
+  process lattice (non-contiguous nodes, a shape which is not a
+  product of the node lattice, ...)
+    1. recursive bisection: the process lattice is cut in half on
+       its longest direction, and the processes (sorted by the node
+       coordinate on the longest axis of the nodes) are cut at the
+       same number, until one process is left
+    2. refinement: simulated annealing of the swaps of two processes
+       on different nodes, with the cost
+         sum of (halo bytes) x (hop distance) over the neighbors,
+       until the time budget or 100 moves per process
+  The random numbers have a fixed seed and the temperature goes down
+  with the number of the moves, so the map is the same for the same
+  input if the budget is not reached.
+
+**************************************************/
+typedef struct {
+  double cost_bisection;   // cost after the recursive bisection
+  double cost;             // cost after the refinement
+  long   moves;
+  long   accepted;
+  double time_sec;
+  const char *unit;
+} fallback_stat;
+
+// rank_list[3*rankid]: the node of each rankid
+//   node_list[3*rank]: the node of each of the np processes of the allocation
+//   returns 0, or -1 if a node is out of the shape
+int  fallback_map(int *rank_list, fallback_stat *stat, const int *node_list, const int *shape,
+                  const int *periodic, const proc_dim *dim, const double budget_sec);
+void print_fallback_stat(FILE *fp, const fallback_stat *stat);
+
+#endif
@@ -0,0 +1,114 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+    2026 Oct. 17 fallback_given, for the programs without the fallback mapper
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "rankmap_option.h"
+
+int get_option(rankmap_option *opt, int *argc, char **argv){
+  opt->analyze=0;
+  opt->congestion=0;
+  opt->table=0;
+  opt->profile=0;
+  opt->physical=0;
+  opt->bind=0;
+  opt->auto_search=0;
+  opt->ppn=0;
+  for(int d=0; d<3; d++){
+    opt->periodic[d]=-1;
+  }
+  for(int mu=0; mu<4; mu++){
+    opt->lattice[mu]=0;
+  }
+  opt->site_bytes=96;  // half spinor in double precision
+  opt->fallback_time=10.0;
+  opt->fallback_given=0;
+  opt->order=NULL;
+  opt->cache_dir=NULL;
+  opt->format=NULL;
+  opt->topology=NULL;
+
+  int n=1;
+  for(int i=1; i<*argc; i++){
+    const char *arg=argv[i];
+    if(strncmp(arg, "--", 2) != 0){
+      argv[n++]=argv[i];
+      continue;
+    }
+    if(strcmp(arg, "--analyze") == 0){
+      opt->analyze=1;
+    } else if(strcmp(arg, "--congestion") == 0){
+      opt->congestion=1;
+    } else if(strcmp(arg, "--table") == 0){
+      opt->table=1;
+    } else if(strcmp(arg, "--profile") == 0){
+      opt->profile=1;
+    } else if(strcmp(arg, "--physical") == 0){
+      opt->physical=1;
+    } else if(strcmp(arg, "--bind") == 0){
+      opt->bind=1;
+    } else if(strcmp(arg, "--auto") == 0){
+      opt->auto_search=1;
+    } else if(strncmp(arg, "--ppn=", 6) == 0){
+      opt->ppn=atoi(arg+6);
+      if(opt->ppn<1){ return i; }
+    } else if(strncmp(arg, "--lattice=", 10) == 0){
+      int *l=opt->lattice;
+      if(sscanf(arg+10, "%dx%dx%dx%d", l, l+1, l+2, l+3) != 4
+         || l[0]<1 || l[1]<1 || l[2]<1 || l[3]<1){ return i; }
+    } else if(strncmp(arg, "--fallback-time=", 16) == 0){
+      char *end;
+      opt->fallback_time=strtod(arg+16, &end);
+      opt->fallback_given=1;
+      if(end==arg+16 || *end || opt->fallback_time<0.0){ return i; }
+    } else if(strncmp(arg, "--site-bytes=", 13) == 0){
+      opt->site_bytes=atoi(arg+13);
+      if(opt->site_bytes<1){ return i; }
+    } else if(strncmp(arg, "--mesh=", 7) == 0){
+      for(int d=0; d<3; d++){
+        opt->periodic[d]=1;
+      }
+      for(const char *c=arg+7; *c; c++){
+        if(*c<'x' || *c>'z'){ return i; }
+        opt->periodic[*c-'x']=0;
+      }
+    } else if(strncmp(arg, "--order=", 8) == 0){
+      opt->order=arg+8;
+      if(!*opt->order){ return i; }
+    } else if(strncmp(arg, "--cache=", 8) == 0){
+      opt->cache_dir=arg+8;
+      if(!*opt->cache_dir){ return i; }
+    } else if(strncmp(arg, "--format=", 9) == 0){
+      opt->format=arg+9;
+      if(!*opt->format){ return i; }
+    } else if(strncmp(arg, "--topology=", 11) == 0){
+      opt->topology=arg+11;
+      if(!*opt->topology){ return i; }
+    } else {
+      return i;
+    }
+  }
+  *argc=n;
+  argv[n]=NULL;
+  return 0;
+}
@@ -0,0 +1,58 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+    2026 Oct. 17 fallback_given, for the programs without the fallback mapper
+ */
+#ifndef rankmap_4d_option_h
+#define rankmap_4d_option_h
+
+/**************************************************
+
+  options of the form --name[=value]
+  they can be given anywhere in the command line
+
+**************************************************/
+typedef struct {
+  int analyze;      // --analyze: print the hop distance of the halo exchange
+  int congestion;   // --congestion: print the link load of the halo exchange
+  int table;        // --table:   write the binary neighbor table
+  int profile;      // --profile: write the time and memory of each phase
+  int physical;     // --physical: the map on the 6-dim Tofu coordinate
+  int bind;         // --bind:    write the CPU and memory binding of each rankid
+  int auto_search;  // --auto:    search the best map
+  int ppn;          // --ppn=N:   number of the processes in a node (0: not given)
+  int periodic[3];  // --mesh=AXES: 0 for the given node axes, 1 for the others
+                    //              (-1: not given)
+  int lattice[4];   // --lattice=LxLxLxL: global lattice size (0: not given)
+  int site_bytes;   // --site-bytes=N: bytes of a halo site (default: 96)
+  double fallback_time;   // --fallback-time=SEC: time budget of the fallback mapper
+                          //   (default: 10, 0: abort if the process lattice does not match)
+  int fallback_given;     //   1 if --fallback-time= is given
+  const char *order;  // --order=NAME: rankid order (NULL: not given)
+  const char *cache_dir;  // --cache=DIR: cache of the generated rankmap (NULL: not given)
+  const char *format;     // --format=NAME: host-based rankmap file (NULL: not given)
+  const char *topology;   // --topology=FILE: topology description file (NULL: not given)
+} rankmap_option;
+
+// removes the options from argc/argv
+//   returns 0, or the position of the unknown option
+int get_option(rankmap_option *opt, int *argc, char **argv);
+
+#endif
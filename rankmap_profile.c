@@ -0,0 +1,138 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+ */
+#include <stdio.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "rankmap_profile.h"
+
+const char *profile_phase_name[PROF_NPHASE]={
+  "mpi_init", "detect_node_np", "cache", "topology", "direction_map", "intra_rank",
+  "collect", "check", "analysis", "output", "table", "other"
+};
+
+static double phase_time[PROF_NPHASE];
+static double phase_bytes[PROF_NPHASE];
+static double phase_start=0.0;
+static double first_start=-1.0;
+static int    current_phase=PROF_OTHER;
+
+
+double profile_wtime(void){
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + 1.0e-9*ts.tv_nsec;
+}
+
+void profile_begin(const int phase){
+  phase_start=profile_wtime();
+  if(first_start<0.0){
+    first_start=phase_start;
+  }
+  current_phase=phase;
+}
+
+void profile_end(const int phase){
+  phase_time[phase]+=profile_wtime()-phase_start;
+  current_phase=PROF_OTHER;
+}
+
+void profile_add_bytes(const double bytes){
+  phase_bytes[current_phase]+=bytes;
+}
+
+double profile_time(const int phase){
+  return phase_time[phase];
+}
+
+double profile_bytes(const int phase){
+  return phase_bytes[phase];
+}
+
+double profile_total_time(void){
+  return (first_start<0.0) ? 0.0 : profile_wtime()-first_start;
+}
+
+// ru_maxrss is in kilobytes on Linux
+long profile_peak_rss_kb(void){
+  struct rusage usage;
+  if(getrusage(RUSAGE_SELF, &usage) != 0){
+    return -1;
+  }
+  return usage.ru_maxrss;
+}
+
+
+static void set_stat(profile_stat *s, const double v){
+  s->min=v;
+  s->max=v;
+  s->avg=v;
+  s->sum=v;
+}
+
+// the time of "other" is the rest of the total time
+void profile_local_report(profile_report *r){
+  double total=profile_total_time();
+  double rest=total;
+  for(int k=0; k<PROF_NPHASE; k++){
+    if(k != PROF_OTHER){
+      rest-=profile_time(k);
+    }
+    set_stat(&r->time[k], profile_time(k));
+    set_stat(&r->bytes[k], profile_bytes(k));
+  }
+  set_stat(&r->time[PROF_OTHER], (rest>0.0) ? rest : 0.0);
+  set_stat(&r->total_time, total);
+  set_stat(&r->peak_rss_kb, (double)profile_peak_rss_kb());
+}
+
+
+static void write_stat(FILE *fp, const char *name, const profile_stat *s, const int with_sum){
+  fprintf(fp, "\"%s\": {\"min\": %.9g, \"max\": %.9g, \"avg\": %.9g", name, s->min, s->max, s->avg);
+  if(with_sum){
+    fprintf(fp, ", \"sum\": %.9g", s->sum);
+  }
+  fprintf(fp, "}");
+}
+
+void profile_write_json(FILE *fp, const profile_report *r){
+  fprintf(fp, "{\n");
+  fprintf(fp, "  \"program\": \"%s\",\n", r->program);
+  fprintf(fp, "  \"rankmap\": \"%s\",\n", r->rankmap);
+  fprintf(fp, "  \"np\": %d,\n", r->np);
+  fprintf(fp, "  \"ppn\": %d,\n", r->ppn);
+  fprintf(fp, "  \"psize\": [%d, %d, %d, %d],\n", r->psize[0], r->psize[1], r->psize[2], r->psize[3]);
+  fprintf(fp, "  \"shape\": [%d, %d, %d],\n", r->shape[0], r->shape[1], r->shape[2]);
+  fprintf(fp, "  \"phases\": [\n");
+  for(int k=0; k<PROF_NPHASE; k++){
+    fprintf(fp, "    {\"name\": \"%s\", ", profile_phase_name[k]);
+    write_stat(fp, "time_sec", &r->time[k], 0);
+    fprintf(fp, ", ");
+    write_stat(fp, "bytes", &r->bytes[k], 1);
+    fprintf(fp, "}%s\n", (k<PROF_NPHASE-1) ? "," : "");
+  }
+  fprintf(fp, "  ],\n");
+  fprintf(fp, "  ");
+  write_stat(fp, "total_time_sec", &r->total_time, 0);
+  fprintf(fp, ",\n  ");
+  write_stat(fp, "peak_rss_kb", &r->peak_rss_kb, 0);
+  fprintf(fp, "\n}\n");
+}
@@ -0,0 +1,91 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+ */
+#ifndef rankmap_4d_profile_h
+#define rankmap_4d_profile_h
+
+#include <stdio.h>
+
+/**************************************************
+
+  wall time and communicated bytes of each phase
+    the time of a phase is accumulated between
+    profile_begin() and profile_end(), which must not be nested;
+    the bytes (sent + received payload of this rank) are
+    added to the current phase, or to PROF_OTHER
+
+**************************************************/
+#define PROF_MPI_INIT    0
+#define PROF_NODE_NP     1   // detect_node_np()
+#define PROF_CACHE       2
+#define PROF_TOPOLOGY    3   // node coordinate and shape
+#define PROF_MAP         4   // direction map, or the automatic search
+#define PROF_INTRA_RANK  5
+#define PROF_COLLECT     6   // rank list on rank 0
+#define PROF_CHECK       7   // sanity check of the rank list and the rankid order
+#define PROF_ANALYSIS    8   // --analyze, --lattice, --congestion
+#define PROF_OUTPUT      9   // output_rankmap()
+#define PROF_TABLE      10   // --table
+#define PROF_OTHER      11
+#define PROF_NPHASE     12
+
+extern const char *profile_phase_name[PROF_NPHASE];
+
+double profile_wtime(void);
+void   profile_begin(const int phase);
+void   profile_end(const int phase);
+void   profile_add_bytes(const double bytes);
+double profile_time(const int phase);
+double profile_bytes(const int phase);
+double profile_total_time(void);   // since the first profile_begin()
+long   profile_peak_rss_kb(void);
+
+/**************************************************
+
+  JSON report
+    min/max/avg (and sum for the bytes) over the ranks
+
+**************************************************/
+typedef struct {
+  double min;
+  double max;
+  double avg;
+  double sum;
+} profile_stat;
+
+typedef struct {
+  const char  *program;
+  const char  *rankmap;
+  int          np;
+  int          ppn;
+  int          psize[4];
+  int          shape[3];
+  profile_stat time[PROF_NPHASE];
+  profile_stat bytes[PROF_NPHASE];
+  profile_stat total_time;
+  profile_stat peak_rss_kb;
+} profile_report;
+
+// the statistics of a single process (the offline generator)
+void profile_local_report(profile_report *r);
+void profile_write_json(FILE *fp, const profile_report *r);
+
+#endif
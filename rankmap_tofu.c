@@ -0,0 +1,206 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "rankmap_4d_core.h"
+#include "rankmap_analyze.h"
+#include "rankmap_tofu.h"
+
+static const int tofu_unit[3]={2,3,2};  // a, b, c
+
+
+/********************************************************
+ * position on a folded axis of each (U,u) of a unit axis
+ *   occ[U*m+u]: the node is in the allocation
+ *   pos[U*m+u]: the position, or -1
+ *   returns the number of the positions
+ ********************************************************/
+static int fold_axis(int *pos, const char *occ, const int num_units, const int m){
+  int count=0;
+  int prev=-1;   // u of the last position
+  for(int U=0; U<num_units; U++){
+    int num=0;
+    for(int u=0; u<m; u++){
+      pos[U*m+u]=-1;
+      num+=occ[U*m+u];
+    }
+    if(num==0){ continue; }
+
+    // start at the last u if possible, or the nearest one on the ring
+    int start=-1;
+    for(int d=0; d<m && start<0; d++){
+      int cand[2]={prev+d, prev-d};
+      for(int k=0; k<2 && start<0; k++){
+        int u = (prev<0) ? d : (cand[k]+m)%m;
+        if(occ[U*m+u]){ start=u; }
+      }
+    }
+    // the nodes of a unit are contiguous on the ring of m
+    int step=1;
+    int n=0;
+    for(int u=start; n<num && occ[U*m+u]; u=(u+step)%m){ n++; }
+    if(n<num){ step=m-1; }
+    n=0;
+    for(int u=start; n<num; u=(u+step)%m){
+      pos[U*m+u]=count++;
+      prev=u;
+      n++;
+    }
+  }
+  return count;
+}
+
+
+int tofu_fold(tofu_map *map, int *folded, const int *tofu_list, const int *node_list, const int n){
+  map->logical=NULL;
+  map->tofu=NULL;
+  int *pos[3]={NULL, NULL, NULL};
+  int err=0;
+  for(int k=0; k<3 && !err; k++){
+    int m=tofu_unit[k];
+    int max_unit=0;
+    for(int i=0; i<n; i++){
+      const int *t=tofu_list+TOFU_DIM*i;
+      if(t[k]<0 || t[3+k]<0 || t[3+k]>=m){
+        fprintf(stderr, "bad Tofu coordinate of the rank %d: %d %d %d %d %d %d\n",
+                i, t[0], t[1], t[2], t[3], t[4], t[5]);
+        err=1;
+        break;
+      }
+      if(t[k]>max_unit){ max_unit=t[k]; }
+    }
+    if(err){ break; }
+    map->tofu_shape[k]=max_unit+1;
+    map->tofu_shape[3+k]=m;
+
+    char *occ=calloc((max_unit+1)*m, 1);
+    for(int i=0; i<n; i++){
+      const int *t=tofu_list+TOFU_DIM*i;
+      occ[t[k]*m+t[3+k]]=1;
+    }
+    pos[k]=malloc(sizeof(int)*(max_unit+1)*m);
+    map->shape[k]=fold_axis(pos[k], occ, max_unit+1, m);
+    free(occ);
+  }
+
+  // the folded coordinate, and the nodes must fill the folded box
+  int num_nodes=0;
+  if(!err){
+    num_nodes=map->shape[0]*map->shape[1]*map->shape[2];
+    map->logical=malloc(sizeof(int)*3*num_nodes);
+    map->tofu=malloc(sizeof(int)*TOFU_DIM*num_nodes);
+    for(int i=0; i<3*num_nodes; i++){
+      map->logical[i]=-1;
+    }
+  }
+  for(int i=0; i<n && !err; i++){
+    const int *t=tofu_list+TOFU_DIM*i;
+    for(int k=0; k<3; k++){
+      folded[3*i+k]=pos[k][t[k]*tofu_unit[k]+t[3+k]];
+    }
+    int node=node_index(folded+3*i, map->shape);
+    int *l=map->logical+3*node;
+    if(l[0]<0){
+      for(int k=0; k<3; k++){
+        l[k]=node_list[3*i+k];
+      }
+      for(int k=0; k<TOFU_DIM; k++){
+        map->tofu[TOFU_DIM*node+k]=t[k];
+      }
+    } else if(l[0]!=node_list[3*i] || l[1]!=node_list[3*i+1] || l[2]!=node_list[3*i+2]){
+      fprintf(stderr, "the rank %d has a different logical coordinate on the same node: %d %d %d\n",
+              i, node_list[3*i], node_list[3*i+1], node_list[3*i+2]);
+      err=1;
+    }
+  }
+  int empty=0;
+  for(int node=0; node<num_nodes && !err; node++){
+    empty += (map->logical[3*node]<0);
+  }
+  if(empty){
+    fprintf(stderr, "the nodes are not a box on XYZabc: %d of the folded %dx%dx%d nodes are not allocated\n",
+            empty, map->shape[0], map->shape[1], map->shape[2]);
+    err=1;
+  }
+  for(int k=0; k<3; k++){
+    free(pos[k]);
+  }
+  if(err){
+    free_tofu_map(map);
+    return 1;
+  }
+  return 0;
+}
+
+
+void tofu_unfold(const tofu_map *map, int *rank_list, int *tofu_rank_list, const int np){
+  for(int r=0; r<np; r++){
+    int node=node_index(rank_list+3*r, map->shape);
+    if(node<0){ continue; }  // detected by check_rank_list()
+    if(tofu_rank_list){
+      for(int k=0; k<TOFU_DIM; k++){
+        tofu_rank_list[TOFU_DIM*r+k]=map->tofu[TOFU_DIM*node+k];
+      }
+    }
+    for(int k=0; k<3; k++){
+      rank_list[3*r+k]=map->logical[3*node+k];
+    }
+  }
+}
+
+
+void tofu_periodic(int *periodic6, const int *periodic){
+  for(int k=0; k<3; k++){
+    periodic6[k]=periodic[k];
+    periodic6[3+k]=(tofu_unit[k]>2);
+  }
+}
+
+
+void free_tofu_map(tofu_map *map){
+  free(map->logical);
+  free(map->tofu);
+  map->logical=NULL;
+  map->tofu=NULL;
+}
+
+
+void print_tofu_halo(FILE *fp, const int *tofu_rank_list, const proc_dim *dim){
+  int shape[TOFU_DIM];
+  int periodic[TOFU_DIM];
+  for(int k=0; k<3; k++){
+    shape[k]=1;
+    shape[3+k]=tofu_unit[k];
+  }
+  for(int r=0; r<np; r++){
+    for(int k=0; k<3; k++){
+      if(tofu_rank_list[TOFU_DIM*r+k]+1 > shape[k]){
+        shape[k]=tofu_rank_list[TOFU_DIM*r+k]+1;
+      }
+    }
+  }
+  tofu_periodic(periodic, dim->periodic);
+  halo_stat stat;
+  analyze_halo_nd(&stat, tofu_rank_list, TOFU_DIM, dim->psize, shape, periodic);
+  print_halo_stat(fp, &stat);
+  free_halo_stat(&stat);
+}
@@ -0,0 +1,65 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+ */
+#ifndef rankmap_4d_tofu_h
+#define rankmap_4d_tofu_h
+
+#include <stdio.h>
+#include "topology.h"
+#include "rankmap_4d_core.h"
+
+/**************************************************
+
+  the map on the physical 6-dim Tofu coordinate (--physical)
+    each of the pairs (X,a), (Y,b), (Z,c) is folded into one axis:
+    the units are visited in the order of X, and the nodes in a unit
+    (a: 2, mesh;  b: 3, ring;  c: 2, mesh) continue from the last one,
+    so that the neighbors on the folded axis are 1 physical hop apart
+    (2 hops at a gap of the units or at the wrap around).
+    The 4-dim map is built on the folded 3-dim node lattice,
+    and the rankmap file has the logical coordinate of the same node.
+
+**************************************************/
+typedef struct {
+  int shape[3];                // folded node shape
+  int tofu_shape[TOFU_DIM];    // extent of X,Y,Z in the allocation, and 2,3,2
+  int *logical;                // logical[3*node]: logical coordinate of the folded node
+  int *tofu;                   // tofu[TOFU_DIM*node]: 6-dim coordinate of the folded node
+} tofu_map;
+
+// n entries (MPI ranks): tofu_list[TOFU_DIM*i], node_list[3*i] (logical)
+//   folded[3*i]: the folded coordinate in map->shape
+//   returns 0 if the nodes are a box on the folded axes
+int  tofu_fold(tofu_map *map, int *folded, const int *tofu_list, const int *node_list, const int n);
+
+// rank_list[3*rankid]: folded to logical coordinate
+//   tofu_rank_list[TOFU_DIM*rankid]: 6-dim coordinate (if not NULL)
+void tofu_unfold(const tofu_map *map, int *rank_list, int *tofu_rank_list, const int np);
+
+// (X,Y,Z) as the logical axes, a and c mesh, b ring
+void tofu_periodic(int *periodic6, const int *periodic);
+
+void free_tofu_map(tofu_map *map);
+
+// hop distance of the halo exchange on XYZabc
+void print_tofu_halo(FILE *fp, const int *tofu_rank_list, const proc_dim *dim);
+
+#endif
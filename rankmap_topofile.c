@@ -0,0 +1,279 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config.h"
+#include "rankmap_topofile.h"
+
+/**************************************************
+
+  topology description file
+
+**************************************************/
+static void init_topofile(topofile *topo){
+  for(int i=0; i<3; i++){
+    topo->shape[i]=0;
+    topo->periodic[i]=1;
+  }
+  topo->ppn=4;
+  topo->num_nodes=0;
+  topo->coords=NULL;
+  topo->hosts=NULL;
+  topo->node_at=NULL;
+}
+
+static int add_node(topofile *topo, int *capacity, const char *host, const int *c,
+                    const char *filename, const int line_no){
+  const int *s=topo->shape;
+  for(int i=0; i<3; i++){
+    if(c[i]<0 || c[i]>=s[i]){
+      fprintf(stderr, "%s:%d: node %s is out of the shape: %d %d %d\n",
+              filename, line_no, host, c[0], c[1], c[2]);
+      return -1;
+    }
+  }
+  int *at=topo->node_at+c[0]+s[0]*(c[1]+s[1]*c[2]);
+  if(*at>=0){
+    fprintf(stderr, "%s:%d: node %s has the same coordinate as %s: %d %d %d\n",
+            filename, line_no, host, topo->hosts+TOPOFILE_HOST_MAX*(*at), c[0], c[1], c[2]);
+    return -1;
+  }
+  if(topo->num_nodes == *capacity){
+    *capacity*=2;
+    topo->coords=realloc(topo->coords, sizeof(int)*3*(*capacity));
+    topo->hosts=realloc(topo->hosts, TOPOFILE_HOST_MAX*(*capacity));
+  }
+  const int n=topo->num_nodes++;
+  for(int i=0; i<3; i++){
+    topo->coords[3*n+i]=c[i];
+  }
+  strcpy(topo->hosts+TOPOFILE_HOST_MAX*n, host);
+  *at=n;
+  return 0;
+}
+
+int read_topofile(topofile *topo, const char *filename){
+  init_topofile(topo);
+  FILE *fp=fopen(filename, "r");
+  if(!fp){
+    fprintf(stderr, "cannot open the topology file: %s\n", filename);
+    return -1;
+  }
+  int capacity=1024;
+  topo->coords=malloc(sizeof(int)*3*capacity);
+  topo->hosts=malloc(TOPOFILE_HOST_MAX*capacity);
+
+  char line[512];
+  char key[16];
+  char host[TOPOFILE_HOST_MAX];
+  int line_no=0;
+  int err=0;
+  while(!err && fgets(line, sizeof(line), fp)){
+    line_no++;
+    char *comment=strchr(line, '#');
+    if(comment){
+      *comment='\0';
+    }
+    if(sscanf(line, "%15s", key) != 1){
+      continue;
+    }
+    int *s=topo->shape;
+    if(strcmp(key, "shape") == 0){
+      if(topo->node_at){
+        fprintf(stderr, "%s:%d: shape after the nodes\n", filename, line_no);
+        err=-1;
+      } else if(sscanf(line, "%*s %d %d %d", s, s+1, s+2) != 3 || s[0]<1 || s[1]<1 || s[2]<1){
+        fprintf(stderr, "%s:%d: bad shape (must be like: shape 4 3 2)\n", filename, line_no);
+        err=-1;
+      }
+    } else if(strcmp(key, "mesh") == 0){
+      char axes[8]="";
+      sscanf(line, "%*s %7s", axes);
+      for(const char *c=axes; *c && !err; c++){
+        if(*c<'x' || *c>'z'){
+          fprintf(stderr, "%s:%d: bad mesh axes: %s (must be a subset of xyz)\n", filename, line_no, axes);
+          err=-1;
+        } else {
+          topo->periodic[*c-'x']=0;
+        }
+      }
+    } else if(strcmp(key, "ppn") == 0){
+      if(sscanf(line, "%*s %d", &topo->ppn) != 1 || topo->ppn<1){
+        fprintf(stderr, "%s:%d: bad ranks per node\n", filename, line_no);
+        err=-1;
+      }
+    } else if(strcmp(key, "node") == 0){
+      int c[3];
+      if(s[0]<1){
+        fprintf(stderr, "%s:%d: node before the shape\n", filename, line_no);
+        err=-1;
+      } else if(sscanf(line, "%*s %255s %d %d %d", host, c, c+1, c+2) != 4){
+        fprintf(stderr, "%s:%d: bad node (must be like: node HOST x y z)\n", filename, line_no);
+        err=-1;
+      } else {
+        if(!topo->node_at){
+          const int volume=s[0]*s[1]*s[2];
+          topo->node_at=malloc(sizeof(int)*volume);
+          for(int i=0; i<volume; i++){
+            topo->node_at[i]=-1;
+          }
+        }
+        err=add_node(topo, &capacity, host, c, filename, line_no);
+      }
+    } else {
+      fprintf(stderr, "%s:%d: unknown keyword: %s\n", filename, line_no, key);
+      err=-1;
+    }
+  }
+  fclose(fp);
+  if(!err && topo->num_nodes==0){
+    fprintf(stderr, "%s: no node is given\n", filename);
+    err=-1;
+  }
+  if(err){
+    free_topofile(topo);
+  }
+  return err;
+}
+
+const char *topofile_host(const topofile *topo, const int *coords){
+  const int *s=topo->shape;
+  for(int i=0; i<3; i++){
+    if(coords[i]<0 || coords[i]>=s[i]){
+      return NULL;
+    }
+  }
+  const int n=topo->node_at[coords[0]+s[0]*(coords[1]+s[1]*coords[2])];
+  return (n<0) ? NULL : topo->hosts+TOPOFILE_HOST_MAX*n;
+}
+
+void free_topofile(topofile *topo){
+  free(topo->coords);
+  free(topo->hosts);
+  free(topo->node_at);
+  topo->coords=NULL;
+  topo->hosts=NULL;
+  topo->node_at=NULL;
+  topo->num_nodes=0;
+}
+
+
+/**************************************************
+
+  host-based rankmap files
+
+**************************************************/
+static const char *format_name[]={"vcoord", "rankfile", "slurm", "mpich"};
+static const char *format_label[]={"rank map", "Open MPI rankfile", "Slurm host file", "MPICH machine file"};
+
+int hostmap_format(const char *name){
+  for(int f=0; f<4; f++){
+    if(strcmp(name, format_name[f]) == 0){
+      return f;
+    }
+  }
+  return -1;
+}
+
+const char *hostmap_filename(const int format){
+  switch(format){
+  case HOSTMAP_RANKFILE: return RANK_MAP_RANKFILE;
+  case HOSTMAP_SLURM:    return RANK_MAP_SLURM_FILE;
+  case HOSTMAP_MPICH:    return RANK_MAP_MACHINEFILE;
+  default:               return RANK_MAP_FILE;
+  }
+}
+
+int write_hostmap(const char *filename, const int *rank_list, const int np, const int format,
+                  const topofile *topo){
+  FILE *fp=fopen(filename, "w");
+  if(!fp){
+    fprintf(stderr, "cannot open the output file: %s\n", filename);
+    return 1;
+  }
+  int *slot=calloc(topo->num_nodes, sizeof(int));  // ranks already on the node
+  const char *prev=NULL;
+  int count=0;
+  int err=0;
+  for(int r=0; r<np && !err; r++){
+    const int *c=rank_list+3*r;
+    const char *host=topofile_host(topo, c);
+    if(!host){
+      fprintf(stderr, "rankid %d: no host at the node %d %d %d\n", r, c[0], c[1], c[2]);
+      err=1;
+      break;
+    }
+    switch(format){
+    case HOSTMAP_RANKFILE:
+      {
+        const int n=(host-topo->hosts)/TOPOFILE_HOST_MAX;
+        fprintf(fp, "rank %d=%s slot=%d\n", r, host, slot[n]++);
+      }
+      break;
+    case HOSTMAP_SLURM:
+      fprintf(fp, "%s\n", host);
+      break;
+    case HOSTMAP_MPICH:
+      // consecutive rankids on the same node in one line
+      if(prev && strcmp(prev, host) != 0){
+        fprintf(fp, "%s:%d\n", prev, count);
+        count=0;
+      }
+      prev=host;
+      count++;
+      break;
+    default:
+      fprintf(fp, "(%d,%d,%d)\n", c[0], c[1], c[2]);
+    }
+  }
+  if(!err && prev){
+    fprintf(fp, "%s:%d\n", prev, count);
+  }
+  free(slot);
+  err |= (ferror(fp) != 0);
+  err |= (fclose(fp) != 0);
+  if(err){
+    fprintf(stderr, "error in writing: %s\n", filename);
+  }
+  return err;
+}
+
+int output_hostmap(const int *rank_list, const int np, const int format, const char *topology){
+  if(!topology){
+    topology=getenv("RANKMAP_TOPOLOGY_FILE");
+  }
+  if(!topology){
+    fprintf(stderr, "--format=%s: the host names need --topology=FILE or RANKMAP_TOPOLOGY_FILE\n",
+            format_name[format]);
+    return 1;
+  }
+  topofile topo;
+  if(read_topofile(&topo, topology)){
+    return 1;
+  }
+  const char *filename=hostmap_filename(format);
+  printf("%s: %s\n", format_label[format], filename);
+  int err=write_hostmap(filename, rank_list, np, format, &topo);
+  free_topofile(&topo);
+  return err;
+}
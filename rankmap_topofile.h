@@ -0,0 +1,84 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+ */
+#ifndef rankmap_4d_topofile_h
+#define rankmap_4d_topofile_h
+
+#include "rankmap4d_prefix.h"
+
+/**************************************************
+
+  topology description file of a generic torus/mesh cluster
+    # comment
+    shape 8 6 4           node lattice (required, before the nodes)
+    mesh z                non-periodic node axes (default: none)
+    ppn 4                 ranks per node (default: 4)
+    node n0001 0 0 0      host name and coordinate of each node,
+    node n0002 1 0 0      in the MPI rank order
+    ...
+  the n-th node hosts the ranks n*ppn, ..., (n+1)*ppn-1
+
+**************************************************/
+#define TOPOFILE_HOST_MAX 256
+
+typedef struct {
+  int shape[3];
+  int periodic[3];
+  int ppn;
+  int num_nodes;
+  int *coords;       // coords[3*n]: coordinate of the n-th node
+  char *hosts;       // hosts+TOPOFILE_HOST_MAX*n: host name of the n-th node
+  int *node_at;      // node_at[x+shape[0]*(y+shape[1]*z)]: the node, or -1
+} topofile;
+
+// returns 0, or -1 with a message to stderr
+int  read_topofile(topofile *topo, const char *filename);
+// host name of the node at coords, or NULL
+const char *topofile_host(const topofile *topo, const int *coords);
+void free_topofile(topofile *topo);
+
+/**************************************************
+
+  host-based rankmap files for other launchers (--format=NAME)
+    vcoord   : "(x,y,z)" of Fujitsu MPI (the rankmap file itself)
+    rankfile : Open MPI rankfile "rank R=HOST slot=S"
+    slurm    : one host per rankid (SLURM_HOSTFILE, srun -m arbitrary)
+    mpich    : MPICH machinefile "HOST:N", consecutive rankids
+  the host name of a rankid comes from its node coordinate
+
+**************************************************/
+#define HOSTMAP_VCOORD   0
+#define HOSTMAP_RANKFILE 1
+#define HOSTMAP_SLURM    2
+#define HOSTMAP_MPICH    3
+
+// returns the format, or -1 if unknown
+int hostmap_format(const char *name);
+// output filename of the format
+const char *hostmap_filename(const int format);
+// returns 0 if success
+int write_hostmap(const char *filename, const int *rank_list, const int np, const int format,
+                  const topofile *topo);
+// writes the file of the format with the host names in the topology file
+//   (RANKMAP_TOPOLOGY_FILE if NULL); returns 0 if success
+int output_hostmap(const int *rank_list, const int np, const int format, const char *topology);
+
+#endif
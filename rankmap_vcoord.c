@@ -0,0 +1,137 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+ */
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "rankmap_vcoord.h"
+
+
+int vcoord_open(vcoord_reader *r, const char *filename){
+  r->base=NULL;
+  r->size=0;
+  r->p=NULL;
+  r->line=0;
+  int fd=open(filename, O_RDONLY);
+  if(fd<0){
+    fprintf(stderr, "cannot open the rankmap file: %s\n", filename);
+    return 1;
+  }
+  struct stat st;
+  if(fstat(fd, &st) != 0){
+    fprintf(stderr, "cannot stat the rankmap file: %s\n", filename);
+    close(fd);
+    return 1;
+  }
+  r->size=st.st_size;
+  if(r->size>0){
+    void *m=mmap(NULL, r->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(m==MAP_FAILED){
+      fprintf(stderr, "cannot map the rankmap file: %s\n", filename);
+      close(fd);
+      return 1;
+    }
+    madvise(m, r->size, MADV_SEQUENTIAL);
+    r->base=m;
+  }
+  close(fd);  // the mapping stays
+  r->p=r->base;
+  return 0;
+}
+
+
+void vcoord_close(vcoord_reader *r){
+  if(r->base){
+    munmap(r->base, r->size);
+  }
+  r->base=NULL;
+  r->p=NULL;
+}
+
+
+static int is_blank(const char c){
+  return c==' ' || c=='\t' || c=='\r';
+}
+
+// non-negative decimal integer; returns the next position, or NULL
+static const char *get_int(const char *p, const char *end, int *v){
+  while(p<end && is_blank(*p)){ p++; }
+  if(p==end || *p<'0' || *p>'9'){
+    return NULL;
+  }
+  long x=0;
+  while(p<end && *p>='0' && *p<='9'){
+    x=10*x + (*p-'0');
+    if(x > 0x7fffffff){
+      return NULL;
+    }
+    p++;
+  }
+  while(p<end && is_blank(*p)){ p++; }
+  *v=(int)x;
+  return p;
+}
+
+
+int vcoord_next(vcoord_reader *r, int *c){
+  const char *end=r->base + r->size;
+  const char *p=r->p;
+  while(p<end){
+    // start of a line
+    r->line++;
+    while(p<end && is_blank(*p)){ p++; }
+    if(p<end && (*p=='\n' || *p=='#')){
+      while(p<end && *p != '\n'){ p++; }
+      if(p<end){ p++; }
+      continue;
+    }
+    if(p==end){
+      break;
+    }
+
+    // "(x,y,z)"
+    const char sep[3]={',', ',', ')'};
+    if(*p++ != '('){
+      r->p=p;
+      return -1;
+    }
+    for(int i=0; i<3; i++){
+      p=get_int(p, end, c+i);
+      if(!p || p==end || *p != sep[i]){
+        r->p=end;
+        return -1;
+      }
+      p++;
+    }
+    while(p<end && is_blank(*p)){ p++; }
+    if(p<end && *p != '\n'){
+      r->p=p;
+      return -1;
+    }
+    if(p<end){ p++; }
+    r->p=p;
+    return 1;
+  }
+  r->p=end;
+  return 0;
+}
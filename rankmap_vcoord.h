@@ -0,0 +1,50 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+ */
+#ifndef rankmap_4d_vcoord_h
+#define rankmap_4d_vcoord_h
+
+#include <stddef.h>
+
+/**************************************************
+
+  streaming reader of a vcoordfile "(x,y,z)" per line
+    the file is mapped with mmap and parsed in place:
+    no line buffer, and the memory does not depend on the file size
+    blank lines and lines starting with '#' are skipped
+
+**************************************************/
+typedef struct {
+  char       *base;   // mapped file
+  size_t      size;
+  const char *p;      // next character to parse
+  long        line;   // line number of the last entry (from 1)
+} vcoord_reader;
+
+// returns 0 if success
+int  vcoord_open(vcoord_reader *r, const char *filename);
+void vcoord_close(vcoord_reader *r);
+
+// the next entry: returns 1 with c[0..2], 0 at the end of the file,
+//   or -1 for a syntax error at r->line
+int  vcoord_next(vcoord_reader *r, int *c);
+
+#endif
@@ -0,0 +1,82 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "rankmap_write.h"
+
+// decimal digits of v, returns the next position
+static char *put_int(char *p, const int v){
+  char tmp[12];
+  int n=0;
+  unsigned int u = (v<0) ? -(unsigned int)v : (unsigned int)v;
+  if(v<0){
+    *p++='-';
+  }
+  do {
+    tmp[n++]='0' + u%10;
+    u/=10;
+  } while(u);
+  while(n){
+    *p++=tmp[--n];
+  }
+  return p;
+}
+
+
+long format_rankmap(char *buf, const int *rank_list, const int n){
+  char *p=buf;
+  for(int i=0; i<n; i++){
+    *p++='(';
+    p=put_int(p, rank_list[3*i]);
+    *p++=',';
+    p=put_int(p, rank_list[3*i+1]);
+    *p++=',';
+    p=put_int(p, rank_list[3*i+2]);
+    *p++=')';
+    *p++='\n';
+  }
+  return p-buf;
+}
+
+
+int write_rankmap_file(const char *filename, const int *rank_list, const int np){
+  const int block=RANKMAP_WRITE_BUFFER/RANKMAP_LINE_MAX;
+  remove(filename);  // may be a hard link to the cache
+  FILE *fp=fopen(filename, "w");
+  if(!fp){
+    fprintf(stderr, "cannot open the output file: %s\n", filename);
+    return 1;
+  }
+  char *buf=malloc(RANKMAP_WRITE_BUFFER);
+  int err=0;
+  for(int i=0; i<np && !err; i+=block){
+    int n = (np-i < block) ? np-i : block;
+    long len=format_rankmap(buf, rank_list+3*i, n);
+    err = (fwrite(buf, 1, len, fp) != (size_t)len);
+  }
+  free(buf);
+  err |= (fclose(fp) != 0);
+  if(err){
+    fprintf(stderr, "error in writing: %s\n", filename);
+  }
+  return err;
+}
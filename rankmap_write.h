@@ -0,0 +1,44 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+ */
+#ifndef rankmap_4d_write_h
+#define rankmap_4d_write_h
+
+#include "rankmap4d_prefix.h"
+
+/**************************************************
+
+  writer of the rankmap file "(x,y,z)\n"
+    the lines are formatted with a simple itoa into a buffer
+    of RANKMAP_WRITE_BUFFER bytes, which is written at once
+
+**************************************************/
+#define RANKMAP_WRITE_BUFFER (4*1024*1024)
+
+// formats n entries of rank_list into buf; returns the number of bytes
+//   buf must have RANKMAP_LINE_MAX bytes for each entry
+#define RANKMAP_LINE_MAX 40
+long format_rankmap(char *buf, const int *rank_list, const int n);
+
+// returns 0 if success
+int write_rankmap_file(const char *filename, const int *rank_list, const int np);
+
+#endif
@@ -0,0 +1,83 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+    2026 Oct. 17 physical 6-dim Tofu coordinate (topology_get_tofu_coords)
+    2026 Oct. 17 topology description file (topology_file.c), topology_sim_nodes
+ */
+#ifndef rankmap_4d_topology_h
+#define rankmap_4d_topology_h
+
+#include "rankmap4d_prefix.h"
+
+/**************************************************
+
+  topology provider: the 3-dim node coordinate of each MPI rank
+    topology_fjmpi.c : Fujitsu MPI (FJMPI_Topology_*)
+    topology_sim.c   : simulated topology (no Tofu required)
+    topology_file.c  : generic torus/mesh cluster, given by the topology
+                       description file RANKMAP_TOPOLOGY_FILE
+                       (see rankmap_topofile.h)
+
+  one of them is linked, as calc_rankid.c
+
+**************************************************/
+#define TOPOLOGY_SUCCESS 0
+#define TOPOLOGY_ERROR   1
+
+int topology_get_dimension(int *dim);
+int topology_get_coords(const int rank, const int dim, int *coords);
+int topology_get_shape(int *shape);
+// 1 if the node axis is a torus, 0 if it is a mesh
+int topology_get_periodic(int *periodic);
+
+// physical 6-dim Tofu coordinate (X,Y,Z,a,b,c) of the node of the rank,
+//   relative to the allocation (--physical)
+#define TOFU_DIM 6
+int topology_get_tofu_coords(const int rank, int *coords);
+
+// for output log
+extern const char* topology_name;
+
+/**************************************************
+
+  configuration of the simulated topology (topology_sim.c)
+    if not given, it is read from the environment variables
+      RANKMAP_SIM_SHAPE     node shape, e.g. 4x3x2 (required)
+      RANKMAP_SIM_PPN       ranks per node (default: 4)
+      RANKMAP_SIM_ORDER     order of the nodes in the MPI rank,
+                            fastest first (default: xyz)
+      RANKMAP_SIM_NODEFILE  file of the node coordinates "x y z",
+                            one node per line in the MPI rank order
+                            (for non-contiguous allocations)
+      RANKMAP_SIM_MESH      non-periodic node axes, e.g. xz
+                            (default: none)
+      RANKMAP_SIM_TOFU_OFFSET  position of the logical node 0 in the
+                            Tofu units, e.g. 1,0,1 (default: 0,0,0);
+                            for the 6-dim coordinate of the logical node x,
+                            x+offset runs over the units with a (b, c) fastest
+
+**************************************************/
+//   only in topology_sim.c: the offline generator links it
+int topology_sim_config(const int *shape, const int ppn, const char *order, const char *nodefile);
+// coordinates of the nodes in the MPI rank order, as RANKMAP_SIM_NODEFILE
+//   (called after topology_sim_config)
+int topology_sim_nodes(const int *coords, const int num_nodes);
+
+#endif
@@ -0,0 +1,94 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "topology.h"
+#include "rankmap_topofile.h"
+
+// topology provider of a generic torus/mesh cluster,
+//   given by the topology description file (see rankmap_topofile.h)
+static int file_ready=0;
+static topofile file_topo;
+
+static int check_ready(void){
+  if(file_ready){
+    return TOPOLOGY_SUCCESS;
+  }
+  const char *filename=getenv("RANKMAP_TOPOLOGY_FILE");
+  if(!filename){
+    fprintf(stderr, "topology file: RANKMAP_TOPOLOGY_FILE is not set\n");
+    return TOPOLOGY_ERROR;
+  }
+  if(read_topofile(&file_topo, filename)){
+    return TOPOLOGY_ERROR;
+  }
+  file_ready=1;
+  return TOPOLOGY_SUCCESS;
+}
+
+int topology_get_dimension(int *dim){
+  *dim=3;
+  return check_ready();
+}
+
+int topology_get_coords(const int rank, const int dim, int *coords){
+  if(check_ready() != TOPOLOGY_SUCCESS || dim != 3 || rank < 0){
+    return TOPOLOGY_ERROR;
+  }
+  const int node = rank / file_topo.ppn;
+  if(node >= file_topo.num_nodes){
+    fprintf(stderr, "topology file: rank %d is not in the file (%d nodes, %d ranks per node)\n",
+            rank, file_topo.num_nodes, file_topo.ppn);
+    return TOPOLOGY_ERROR;
+  }
+  for(int i=0; i<3; i++){
+    coords[i]=file_topo.coords[3*node+i];
+  }
+  return TOPOLOGY_SUCCESS;
+}
+
+// no Tofu coordinate on a generic cluster
+int topology_get_tofu_coords(const int rank, int *coords){
+  (void)rank;
+  (void)coords;
+  fprintf(stderr, "topology file: no 6-dim Tofu coordinate (--physical)\n");
+  return TOPOLOGY_ERROR;
+}
+
+int topology_get_shape(int *shape){
+  int rc=check_ready();
+  for(int i=0; i<3; i++){
+    shape[i]=file_topo.shape[i];
+  }
+  return rc;
+}
+
+int topology_get_periodic(int *periodic){
+  int rc=check_ready();
+  for(int i=0; i<3; i++){
+    periodic[i]=file_topo.periodic[i];
+  }
+  return rc;
+}
+
+// for output log
+const char* topology_name="topology file";
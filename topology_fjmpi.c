@@ -0,0 +1,58 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+    2026 Oct. 17 physical 6-dim Tofu coordinate (FJMPI_TOFU_REL)
+    2026 Oct. 17 removed topology_sim_config(), only in topology_sim.c
+ */
+#include <mpi.h>
+#include <mpi-ext.h>
+#include "topology.h"
+
+// topology provider with Fujitsu MPI
+int topology_get_dimension(int *dim){
+  int rc=FJMPI_Topology_get_dimension(dim);
+  return (rc == FJMPI_SUCCESS) ? TOPOLOGY_SUCCESS : TOPOLOGY_ERROR;
+}
+
+int topology_get_coords(const int rank, const int dim, int *coords){
+  int rc=FJMPI_Topology_get_coords(MPI_COMM_WORLD, rank, FJMPI_LOGICAL, dim, coords);
+  return (rc == FJMPI_SUCCESS) ? TOPOLOGY_SUCCESS : TOPOLOGY_ERROR;
+}
+
+int topology_get_shape(int *shape){
+  int rc=FJMPI_Topology_get_shape(shape, shape+1, shape+2);
+  return (rc == FJMPI_SUCCESS) ? TOPOLOGY_SUCCESS : TOPOLOGY_ERROR;
+}
+
+int topology_get_tofu_coords(const int rank, int *coords){
+  int rc=FJMPI_Topology_get_coords(MPI_COMM_WORLD, rank, FJMPI_TOFU_REL, TOFU_DIM, coords);
+  return (rc == FJMPI_SUCCESS) ? TOPOLOGY_SUCCESS : TOPOLOGY_ERROR;
+}
+
+int topology_get_periodic(int *periodic){
+  // not provided by FJMPI: assume a torus (use --mesh=AXES for a mesh)
+  for(int i=0; i<3; i++){
+    periodic[i]=1;
+  }
+  return TOPOLOGY_SUCCESS;
+}
+
+// for output log
+const char* topology_name="FJMPI";
@@ -0,0 +1,271 @@
+/*
+  4-dim rankmap generator for Fugaku
+     Copyright(c) 2020,2022,2023 Issaku Kanamori <kanamori-i@riken.jp>
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 3
+  of the License, or any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+
+  See the full license in the file "LICENSE".
+
+    2026 Oct. 17 the first version
+    2026 Oct. 17 physical 6-dim Tofu coordinate (RANKMAP_SIM_TOFU_OFFSET)
+    2026 Oct. 17 nodes of the allocation from the topology file (topology_sim_nodes)
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "topology.h"
+
+// simulated topology provider
+static int sim_ready=0;
+static int sim_shape[3];
+static int sim_ppn=4;
+static int sim_order[3]={0,1,2};   // sim_order[0] is the fastest running direction
+static int *sim_nodes=NULL;        // 3-dim coordinates given in the node file
+static int sim_num_nodes=0;
+static int sim_periodic[3]={1,1,1};
+static int sim_tofu_offset[3]={0,0,0};
+static const int tofu_unit[3]={2,3,2};  // a, b, c
+
+static int set_shape(const char *str){
+  if(sscanf(str, "%dx%dx%d", sim_shape, sim_shape+1, sim_shape+2) != 3
+     || sim_shape[0]<1 || sim_shape[1]<1 || sim_shape[2]<1){
+    fprintf(stderr, "simulated topology: bad shape: %s (must be like 4x3x2)\n", str);
+    return TOPOLOGY_ERROR;
+  }
+  return TOPOLOGY_SUCCESS;
+}
+
+static int set_order(const char *str){
+  int flag[3]={0};
+  if(strlen(str) != 3){
+    fprintf(stderr, "simulated topology: bad node order: %s (must be a permutation of xyz)\n", str);
+    return TOPOLOGY_ERROR;
+  }
+  for(int i=0; i<3; i++){
+    int d = str[i]-'x';
+    if(d < 0 || d > 2 || flag[d]>0){
+      fprintf(stderr, "simulated topology: bad node order: %s (must be a permutation of xyz)\n", str);
+      return TOPOLOGY_ERROR;
+    }
+    sim_order[i]=d;
+    flag[d]++;
+  }
+  return TOPOLOGY_SUCCESS;
+}
+
+static int set_mesh(const char *str){
+  for(int i=0; i<3; i++){
+    sim_periodic[i]=1;
+  }
+  for(const char *c=str; *c; c++){
+    int d = *c-'x';
+    if(d < 0 || d > 2){
+      fprintf(stderr, "simulated topology: bad mesh axes: %s (must be a subset of xyz)\n", str);
+      return TOPOLOGY_ERROR;
+    }
+    sim_periodic[d]=0;
+  }
+  return TOPOLOGY_SUCCESS;
+}
+
+static int set_tofu_offset(const char *str){
+  if(sscanf(str, "%d,%d,%d", sim_tofu_offset, sim_tofu_offset+1, sim_tofu_offset+2) != 3
+     || sim_tofu_offset[0]<0 || sim_tofu_offset[1]<0 || sim_tofu_offset[2]<0){
+    fprintf(stderr, "simulated topology: bad Tofu offset: %s (must be like 1,0,1)\n", str);
+    return TOPOLOGY_ERROR;
+  }
+  return TOPOLOGY_SUCCESS;
+}
+
+static int read_nodefile(const char *filename){
+  FILE *fp=fopen(filename, "r");
+  if(!fp){
+    fprintf(stderr, "simulated topology: cannot open the node file: %s\n", filename);
+    return TOPOLOGY_ERROR;
+  }
+  int capacity=1024;
+  sim_nodes=malloc(sizeof(int)*3*capacity);
+  sim_num_nodes=0;
+  char line[256];
+  while(fgets(line, sizeof(line), fp)){
+    int c[3];
+    if(line[0]=='#'){ continue; }
+    if(sscanf(line, "%d %d %d", c, c+1, c+2) != 3){ continue; }
+    for(int i=0; i<3; i++){
+      if(c[i] < 0 || c[i] >= sim_shape[i]){
+        fprintf(stderr, "simulated topology: node %d is out of the shape: %d %d %d\n",
+                sim_num_nodes, c[0], c[1], c[2]);
+        fclose(fp);
+        return TOPOLOGY_ERROR;
+      }
+    }
+    if(sim_num_nodes == capacity){
+      capacity*=2;
+      sim_nodes=realloc(sim_nodes, sizeof(int)*3*capacity);
+    }
+    for(int i=0; i<3; i++){
+      sim_nodes[3*sim_num_nodes+i]=c[i];
+    }
+    sim_num_nodes++;
+  }
+  fclose(fp);
+  return TOPOLOGY_SUCCESS;
+}
+
+int topology_sim_config(const int *shape, const int ppn, const char *order, const char *nodefile){
+  const char *env;
+  int rc=TOPOLOGY_SUCCESS;
+  sim_ready=0;
+
+  if(shape){
+    for(int i=0; i<3; i++){
+      sim_shape[i]=shape[i];
+    }
+  } else if((env=getenv("RANKMAP_SIM_SHAPE"))){
+    rc |= set_shape(env);
+  } else {
+    fprintf(stderr, "simulated topology: RANKMAP_SIM_SHAPE is not set\n");
+    return TOPOLOGY_ERROR;
+  }
+
+  if(ppn>0){
+    sim_ppn=ppn;
+  } else if((env=getenv("RANKMAP_SIM_PPN"))){
+    sim_ppn=atoi(env);
+  }
+  if(sim_ppn<1){
+    fprintf(stderr, "simulated topology: bad ranks per node: %d\n", sim_ppn);
+    return TOPOLOGY_ERROR;
+  }
+
+  if(!order){
+    order=getenv("RANKMAP_SIM_ORDER");
+  }
+  if(order){
+    rc |= set_order(order);
+  }
+
+  rc |= set_mesh((env=getenv("RANKMAP_SIM_MESH")) ? env : "");
+  rc |= set_tofu_offset((env=getenv("RANKMAP_SIM_TOFU_OFFSET")) ? env : "0,0,0");
+
+  if(!nodefile){
+    nodefile=getenv("RANKMAP_SIM_NODEFILE");
+  }
+  free(sim_nodes);
+  sim_nodes=NULL;
+  sim_num_nodes=0;
+  if(nodefile && rc == TOPOLOGY_SUCCESS){
+    rc |= read_nodefile(nodefile);
+  }
+
+  if(rc == TOPOLOGY_SUCCESS){
+    sim_ready=1;
+  }
+  return rc;
+}
+
+int topology_sim_nodes(const int *coords, const int num_nodes){
+  for(int n=0; n<num_nodes; n++){
+    for(int i=0; i<3; i++){
+      if(coords[3*n+i] < 0 || coords[3*n+i] >= sim_shape[i]){
+        fprintf(stderr, "simulated topology: node %d is out of the shape: %d %d %d\n",
+                n, coords[3*n], coords[3*n+1], coords[3*n+2]);
+        return TOPOLOGY_ERROR;
+      }
+    }
+  }
+  free(sim_nodes);
+  sim_nodes=malloc(sizeof(int)*3*num_nodes);
+  for(int i=0; i<3*num_nodes; i++){
+    sim_nodes[i]=coords[i];
+  }
+  sim_num_nodes=num_nodes;
+  return TOPOLOGY_SUCCESS;
+}
+
+static int check_ready(void){
+  if(sim_ready){
+    return TOPOLOGY_SUCCESS;
+  }
+  return topology_sim_config(NULL, 0, NULL, NULL);
+}
+
+int topology_get_dimension(int *dim){
+  *dim=3;
+  return check_ready();
+}
+
+int topology_get_coords(const int rank, const int dim, int *coords){
+  if(check_ready() != TOPOLOGY_SUCCESS || dim != 3 || rank < 0){
+    return TOPOLOGY_ERROR;
+  }
+  int node = rank / sim_ppn;
+  if(sim_nodes){
+    if(node >= sim_num_nodes){
+      fprintf(stderr, "simulated topology: rank %d is not in the node file (%d nodes)\n", rank, sim_num_nodes);
+      return TOPOLOGY_ERROR;
+    }
+    for(int i=0; i<3; i++){
+      coords[i]=sim_nodes[3*node+i];
+    }
+    return TOPOLOGY_SUCCESS;
+  }
+
+  if(node >= sim_shape[0]*sim_shape[1]*sim_shape[2]){
+    fprintf(stderr, "simulated topology: rank %d is out of the shape %dx%dx%d with %d ranks per node\n",
+            rank, sim_shape[0], sim_shape[1], sim_shape[2], sim_ppn);
+    return TOPOLOGY_ERROR;
+  }
+  for(int i=0; i<3; i++){
+    int d=sim_order[i];
+    coords[d] = node % sim_shape[d];
+    node /= sim_shape[d];
+  }
+  return TOPOLOGY_SUCCESS;
+}
+
+// the logical axis runs over the Tofu units as X-major, a fastest (no snake),
+// so that a logical step across the units is 2 physical hops
+int topology_get_tofu_coords(const int rank, int *coords){
+  int logical[3];
+  int rc=topology_get_coords(rank, 3, logical);
+  if(rc != TOPOLOGY_SUCCESS){
+    return rc;
+  }
+  for(int i=0; i<3; i++){
+    int pos=logical[i]+sim_tofu_offset[i];
+    coords[i]  =pos/tofu_unit[i] - sim_tofu_offset[i]/tofu_unit[i];  // relative to the allocation
+    coords[3+i]=pos%tofu_unit[i];
+  }
+  return TOPOLOGY_SUCCESS;
+}
+
+int topology_get_shape(int *shape){
+  int rc=check_ready();
+  for(int i=0; i<3; i++){
+    shape[i]=sim_shape[i];
+  }
+  return rc;
+}
+
+int topology_get_periodic(int *periodic){
+  int rc=check_ready();
+  for(int i=0; i<3; i++){
+    periodic[i]=sim_periodic[i];
+  }
+  return rc;
+}
+
+// for output log
+const char* topology_name="simulated";